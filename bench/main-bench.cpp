@@ -0,0 +1,586 @@
+// Engine throughput benchmark: builds synthetic scenes at a chosen size,
+// runs them headless and prints per-phase timings as JSON.
+//
+//   bin/bench [--scene NAME]... [--counts N,N,...] [--ticks N] [--warmup N]
+//             [--threads N] [--store] [--no-render]
+//
+// Scenes: patrol (N patrolling enemies), projectiles (about N live shots,
+// spawned from pools and removed as they expire), tilemap (an N by N tile
+// map with walkers in its corridors) and breakout (N balls among blocks).
+// Without --scene every scene runs; --counts runs each chosen scene at
+// every listed size, e.g. --counts 100,1000,10000 to see how it scales.
+
+#include "base/GameObject.hpp"
+#include "base/GenericComponent.hpp"
+#include "base/JobSystem.hpp"
+#include "base/Level.hpp"
+#include "base/PatrolComponent.hpp"
+#include "base/PhysicsComponent.hpp"
+#include "base/PhysicsManager.hpp"
+#include "base/PoolAllocator.hpp"
+#include "base/RectRenderComponent.hpp"
+#include "base/RemoveOnCollideComponent.hpp"
+#include "base/SimulationClock.hpp"
+#include <SDL.h>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// tags as the games use them, since physics treats some specially
+const int TAG_BLOCK = 3;
+const int TAG_ENEMY = 4;
+const int TAG_BALL = 6;
+const int TAG_WALL = 8;
+const int TAG_PROJECTILE = 9;
+
+const float SIZE = 40;
+
+const int RENDER_W = 1280;
+const int RENDER_H = 720;
+
+/**
+ * A small deterministic generator, so every run builds the same scene
+ */
+class SceneRandom {
+public:
+	SceneRandom(unsigned seed) :
+			mState(seed) {
+	}
+
+	//! A number in [0, n)
+	unsigned next(unsigned n) {
+		mState = mState * 1664525u + 1013904223u;
+		return (mState >> 8) % n;
+	}
+
+private:
+	unsigned mState;
+};
+
+/**
+ * An enemy walking back and forth, as in the platformer and invaders
+ */
+class Walker: public GameObject {
+public:
+	Walker(Level &level, float x, float y, float distance) :
+			GameObject(level, x, y, SIZE, SIZE, TAG_ENEMY) {
+		setPhysicsComponent(
+				std::make_shared<PhysicsComponent>(*this,
+						PhysicsComponent::Type::DYNAMIC_SOLID));
+		setRenderComponent(
+				std::make_shared<RectRenderComponent>(*this, 0x80, 0x00, 0x80));
+		addGenericComponent(
+				std::make_shared<PatrolComponent>(*this, x + distance, y,
+						SIZE * 2));
+	}
+};
+
+/**
+ * Counts down a shot's lifetime and removes it when it runs out
+ */
+class LifetimeComponent: public GenericComponent {
+public:
+	static const unsigned READS = ACCESS_OWNER;
+	static const unsigned WRITES = ACCESS_OWNER;
+
+	LifetimeComponent(GameObject &gameObject, int ticks) :
+			GenericComponent(gameObject), mTicks(ticks) {
+		setCollisionTags(NO_TAGS);
+	}
+
+	void reset(int ticks) {
+		mTicks = ticks;
+	}
+
+	virtual void update(Level &level) override {
+		if (--mTicks == 0) {
+			level.removeObject(getGameObject());
+		}
+	}
+
+private:
+	int mTicks;
+};
+
+/**
+ * A shot flying up the screen, as in invaders
+ */
+class Shot: public GameObject {
+public:
+	Shot(Level &level, float x, float y, int lifetime) :
+			GameObject(level, x, y, SIZE * 0.25, SIZE * 0.25, TAG_PROJECTILE) {
+		setPhysicsComponent(
+				makePooled<PhysicsComponent>(*this,
+						PhysicsComponent::Type::DYNAMIC_SOLID));
+		setRenderComponent(
+				makePooled<RectRenderComponent>(*this, 0xff, 0x00, 0x00));
+		physicsComponent()->setVy(-600);
+		mLifetime = makePooled<LifetimeComponent>(*this, lifetime);
+		addGenericComponent(mLifetime);
+	}
+
+	// called by Level::spawn when a pooled shot is fired again
+	void respawn(float x, float y, int lifetime) {
+		setX(x);
+		setY(y);
+		physicsComponent()->reset();
+		physicsComponent()->setVy(-600);
+		mLifetime->reset(lifetime);
+	}
+
+private:
+	std::shared_ptr<LifetimeComponent> mLifetime;
+};
+
+/**
+ * Fires shots from random columns so about a target number are alive
+ */
+class ShooterComponent: public GenericComponent {
+public:
+	ShooterComponent(GameObject &gameObject, int perTick, int lifetime,
+			int columns) :
+			GenericComponent(gameObject), mPerTick(perTick), mLifetime(
+					lifetime), mColumns(columns), mRandom(7) {
+		setCollisionTags(NO_TAGS);
+	}
+
+	virtual void update(Level &level) override {
+		for (int i = 0; i < mPerTick; i++) {
+			level.spawn<Shot>(mRandom.next(mColumns) * SIZE * 0.5f,
+					RENDER_H + SIZE, mLifetime);
+		}
+	}
+
+private:
+	int mPerTick;
+	int mLifetime;
+	int mColumns;
+	SceneRandom mRandom;
+};
+
+/**
+ * A map tile or breakout block
+ */
+class Block: public GameObject {
+public:
+	Block(Level &level, float x, float y) :
+			GameObject(level, x, y, SIZE, SIZE, TAG_BLOCK) {
+		setStatic(true);
+		setPhysicsComponent(
+				makePooled<PhysicsComponent>(*this,
+						PhysicsComponent::Type::STATIC_SOLID));
+		setRenderComponent(
+				makePooled<RectRenderComponent>(*this, 0x00, 0x80, 0x00));
+	}
+
+	// called by Level::spawn when a pooled block is put back
+	void respawn(float x, float y) {
+		setX(x);
+		setY(y);
+		physicsComponent()->reset();
+	}
+};
+
+/**
+ * A wall around the breakout field
+ */
+class Wall: public GameObject {
+public:
+	Wall(Level &level, float x, float y, float w, float h) :
+			GameObject(level, x, y, w, h, TAG_WALL) {
+		setPhysicsComponent(
+				std::make_shared<PhysicsComponent>(*this,
+						PhysicsComponent::Type::STATIC_SOLID));
+	}
+};
+
+/**
+ * A breakout ball; the physics keeps it bouncing and it knocks out blocks
+ */
+class Ball: public GameObject {
+public:
+	Ball(Level &level, float x, float y, float vx, float vy) :
+			GameObject(level, x, y, SIZE * 0.5, SIZE * 0.5, TAG_BALL) {
+		setPhysicsComponent(
+				std::make_shared<PhysicsComponent>(*this,
+						PhysicsComponent::Type::DYNAMIC_SOLID));
+		setRenderComponent(
+				std::make_shared<RectRenderComponent>(*this, 0xff, 0xff, 0xff));
+		addGenericComponent(
+				std::make_shared<RemoveOnCollideComponent>(*this, TAG_BLOCK,
+						nullptr, -1));
+		physicsComponent()->setVx(vx);
+		physicsComponent()->setVy(vy);
+	}
+};
+
+/**
+ * Puts the breakout blocks back once the balls have cleared them all
+ */
+class RefillComponent: public GenericComponent {
+public:
+	RefillComponent(GameObject &gameObject, int columns, int rows) :
+			GenericComponent(gameObject), mColumns(columns), mRows(rows) {
+		setCollisionTags(NO_TAGS);
+	}
+
+	virtual void update(Level &level) override {
+		if (level.tagCount(TAG_BLOCK) == 0) {
+			fill(level);
+		}
+	}
+
+	void fill(Level &level) {
+		for (int row = 0; row < mRows; row++) {
+			for (int column = 0; column < mColumns; column++) {
+				level.spawn<Block>((column + 1) * SIZE, (row + 1) * SIZE);
+			}
+		}
+	}
+
+private:
+	int mColumns;
+	int mRows;
+};
+
+class BenchLevel;
+typedef void (*SceneBuilder)(BenchLevel &level, long count);
+
+/**
+ * A level holding one synthetic scene
+ */
+class BenchLevel: public Level {
+public:
+	BenchLevel(SceneBuilder builder, long count, bool store) :
+			Level(RENDER_W, RENDER_H, false, 0), mBuilder(builder), mCount(
+					count) {
+		useComponentStore(store);
+	}
+
+	void initialize(SDL_Renderer *renderer) override {
+		finalize();
+		mBuilder(*this, mCount);
+	}
+
+	void makeObject(int tag, std::pair<int, int> position) override {
+	}
+
+	void restoreHealth() override {
+	}
+
+private:
+	SceneBuilder mBuilder;
+	long mCount;
+};
+
+// Walkers on a square grid, each patrolling its own gap
+void buildPatrol(BenchLevel &level, long count) {
+	long side = 1;
+	while (side * side < count) {
+		side++;
+	}
+	for (long i = 0; i < count; i++) {
+		float x = (i % side) * SIZE * 4;
+		float y = (i / side) * SIZE * 2;
+		level.addObject(std::make_shared<Walker>(level, x, y, SIZE * 2));
+	}
+}
+
+// Shots live a second, so a steady count needs count / 60 new ones a tick;
+// the first second's worth are made up front with staggered lifetimes
+void buildProjectiles(BenchLevel &level, long count) {
+	const int lifetime = 60;
+	int perTick = std::max<long>(1, count / lifetime);
+	int columns = RENDER_W * 2 / SIZE;
+	SceneRandom random(3);
+	for (long i = 0; i < count; i++) {
+		int age = i % lifetime;
+		level.spawn<Shot>(random.next(columns) * SIZE * 0.5f,
+				RENDER_H + SIZE - age * 10.0f, lifetime - age);
+	}
+	std::shared_ptr<GameObject> shooter = std::make_shared<GameObject>(level,
+			0, 0, 0, 0, 0);
+	shooter->addGenericComponent(
+			std::make_shared<ShooterComponent>(*shooter, perTick, lifetime,
+					columns));
+	level.addObject(shooter);
+}
+
+// Every fourth row is a corridor with a walker every ten tiles; the rest
+// is solid ground
+void buildTilemap(BenchLevel &level, long count) {
+	for (long row = 0; row < count; row++) {
+		for (long column = 0; column < count; column++) {
+			float x = column * SIZE;
+			float y = row * SIZE;
+			if (row % 4 != 1) {
+				level.spawn<Block>(x, y);
+			} else if (column % 10 == 0 && column + 3 < count) {
+				level.addObject(
+						std::make_shared<Walker>(level, x, y, SIZE * 3));
+			}
+		}
+	}
+}
+
+// Balls start in the lower half, heading every which way
+void buildBreakout(BenchLevel &level, long count) {
+	const int columns = RENDER_W / SIZE - 2;
+	const int rows = 8;
+	level.addObject(
+			std::make_shared<Wall>(level, -SIZE, -SIZE, RENDER_W + 2 * SIZE,
+					SIZE));
+	level.addObject(
+			std::make_shared<Wall>(level, -SIZE, RENDER_H, RENDER_W + 2 * SIZE,
+					SIZE));
+	level.addObject(std::make_shared<Wall>(level, -SIZE, 0, SIZE, RENDER_H));
+	level.addObject(
+			std::make_shared<Wall>(level, RENDER_W, 0, SIZE, RENDER_H));
+
+	std::shared_ptr<GameObject> refill = std::make_shared<GameObject>(level, 0,
+			0, 0, 0, 0);
+	std::shared_ptr<RefillComponent> component = std::make_shared<
+			RefillComponent>(*refill, columns, rows);
+	refill->addGenericComponent(component);
+	level.addObject(refill);
+	component->fill(level);
+
+	SceneRandom random(5);
+	for (long i = 0; i < count; i++) {
+		float x = SIZE + random.next(RENDER_W - 3 * SIZE);
+		float y = RENDER_H / 2 + random.next(RENDER_H / 2 - SIZE);
+		float vx = float(random.next(801)) - 400;
+		float vy = -100.0f - random.next(300);
+		level.addObject(std::make_shared<Ball>(level, x, y, vx, vy));
+	}
+}
+
+struct Scene {
+	const char *name;
+	SceneBuilder builder;
+	long defaultCount;
+};
+
+const Scene SCENES[] = { { "patrol", buildPatrol, 10000 }, { "projectiles",
+		buildProjectiles, 5000 }, { "tilemap", buildTilemap, 500 }, {
+		"breakout", buildBreakout, 1000 } };
+
+/**
+ * Timings of one phase, one sample per tick
+ */
+class PhaseSamples {
+public:
+	PhaseSamples(const char *name) :
+			mName(name) {
+	}
+
+	void add(double microseconds) {
+		mSamples.push_back(microseconds);
+	}
+
+	// nearest-rank percentiles
+	void writeJson(std::ostream &out) {
+		std::sort(mSamples.begin(), mSamples.end());
+		double sum = 0;
+		for (double sample : mSamples) {
+			sum += sample;
+		}
+		out << "\"" << mName << "\": {\"mean_us\": "
+				<< (mSamples.empty() ? 0 : sum / mSamples.size())
+				<< ", \"p50_us\": " << percentile(50) << ", \"p99_us\": "
+				<< percentile(99) << ", \"max_us\": "
+				<< (mSamples.empty() ? 0 : mSamples.back()) << "}";
+	}
+
+private:
+	double percentile(int p) const {
+		if (mSamples.empty()) {
+			return 0;
+		}
+		std::size_t rank = (mSamples.size() * p + 99) / 100;
+		return mSamples[std::max<std::size_t>(rank, 1) - 1];
+	}
+
+	const char *mName;
+	std::vector<double> mSamples;
+};
+
+struct BenchOptions {
+	std::vector<std::string> scenes;
+	std::vector<long> counts;
+	long ticks = 300;
+	long warmup = 30;
+	unsigned threads = 0;
+	bool store = false;
+	bool render = true;
+};
+
+double elapsedMicroseconds(Uint64 start, Uint64 end) {
+	return (end - start) * 1e6 / SDL_GetPerformanceFrequency();
+}
+
+void runScene(const Scene &scene, long count, const BenchOptions &options,
+		SDL_Renderer *renderer, std::ostream &out) {
+	PhysicsManager::getInstance().startUp();
+	SimulationClock::getInstance().startUp();
+	PhaseSamples update("update");
+	PhaseSamples physics("physics");
+	PhaseSamples postStep("postStep");
+	PhaseSamples removal("removal");
+	PhaseSamples render("render");
+	std::size_t objects;
+	double setupMs;
+	int drawCalls = 0; // of the last frame rendered
+	{
+		BenchLevel level(scene.builder, count, options.store);
+		Uint64 start = SDL_GetPerformanceCounter();
+		level.initialize(renderer);
+		setupMs = elapsedMicroseconds(start, SDL_GetPerformanceCounter())
+				/ 1000;
+
+		for (long tick = 0; tick < options.warmup + options.ticks; tick++) {
+			bool measured = tick >= options.warmup;
+			Uint64 t0 = SDL_GetPerformanceCounter();
+			level.enterObjects();
+			level.updateComponents();
+			Uint64 t1 = SDL_GetPerformanceCounter();
+			level.stepPhysics();
+			Uint64 t2 = SDL_GetPerformanceCounter();
+			level.postStep();
+			Uint64 t3 = SDL_GetPerformanceCounter();
+			level.removeObjects();
+			Uint64 t4 = SDL_GetPerformanceCounter();
+			if (options.render) {
+				SDL_SetRenderDrawColor(renderer, 0x22, 0x22, 0x22, 0xFF);
+				SDL_RenderClear(renderer);
+				level.render(renderer);
+				drawCalls = level.drawCalls();
+			}
+			Uint64 t5 = SDL_GetPerformanceCounter();
+			if (measured) {
+				update.add(elapsedMicroseconds(t0, t1));
+				physics.add(elapsedMicroseconds(t1, t2));
+				postStep.add(elapsedMicroseconds(t2, t3));
+				removal.add(elapsedMicroseconds(t3, t4));
+				render.add(elapsedMicroseconds(t4, t5));
+			}
+		}
+		objects = level.objectCount();
+		level.finalize();
+	}
+	PhysicsManager::getInstance().shutDown();
+
+	out << "    {\"scene\": \"" << scene.name << "\", \"count\": " << count
+			<< ", \"objects\": " << objects << ", \"setup_ms\": " << setupMs
+			<< ", \"draw_calls\": " << drawCalls << ",\n     \"phases\": {";
+	update.writeJson(out);
+	out << ", ";
+	physics.writeJson(out);
+	out << ",\n                ";
+	postStep.writeJson(out);
+	out << ", ";
+	removal.writeJson(out);
+	out << ",\n                ";
+	render.writeJson(out);
+	out << "}}";
+}
+
+bool parseOptions(int argc, char **argv, BenchOptions &options) {
+	for (int i = 1; i < argc; i++) {
+		bool hasValue = i + 1 < argc;
+		if (std::strcmp(argv[i], "--scene") == 0 && hasValue) {
+			options.scenes.push_back(argv[++i]);
+		} else if (std::strcmp(argv[i], "--counts") == 0 && hasValue) {
+			std::stringstream list(argv[++i]);
+			std::string count;
+			while (getline(list, count, ',')) {
+				options.counts.push_back(std::atol(count.c_str()));
+			}
+		} else if (std::strcmp(argv[i], "--ticks") == 0 && hasValue) {
+			options.ticks = std::atol(argv[++i]);
+		} else if (std::strcmp(argv[i], "--warmup") == 0 && hasValue) {
+			options.warmup = std::atol(argv[++i]);
+		} else if (std::strcmp(argv[i], "--threads") == 0 && hasValue) {
+			options.threads = std::atoi(argv[++i]);
+		} else if (std::strcmp(argv[i], "--store") == 0) {
+			options.store = true;
+		} else if (std::strcmp(argv[i], "--no-render") == 0) {
+			options.render = false;
+		} else {
+			std::cerr << "Unknown option " << argv[i] << "\n";
+			return false;
+		}
+	}
+	for (const std::string &name : options.scenes) {
+		bool known = false;
+		for (const Scene &scene : SCENES) {
+			known = known || name == scene.name;
+		}
+		if (!known) {
+			std::cerr << "Unknown scene " << name << "\n";
+			return false;
+		}
+	}
+	return true;
+}
+
+int main(int argc, char **argv) {
+	BenchOptions options;
+	if (!parseOptions(argc, argv, options)) {
+		return 1;
+	}
+
+	// draws into memory, so no display is needed
+	SDL_Surface *target = SDL_CreateRGBSurfaceWithFormat(0, RENDER_W, RENDER_H,
+			32, SDL_PIXELFORMAT_ARGB8888);
+	SDL_Renderer *renderer =
+			target != nullptr ? SDL_CreateSoftwareRenderer(target) : nullptr;
+	if (renderer == nullptr) {
+		std::cerr << "Could not create a software renderer: " << SDL_GetError()
+				<< "\n";
+		options.render = false;
+	}
+	JobSystem::getInstance().startUp(options.threads);
+
+	std::cout.setf(std::ios::fixed);
+	std::cout.precision(2);
+	std::cout << "{\n  \"threads\": " << JobSystem::getInstance().threadCount()
+			<< ", \"component_store\": " << (options.store ? "true" : "false")
+			<< ", \"render\": " << (options.render ? "true" : "false")
+			<< ", \"ticks\": " << options.ticks << ", \"warmup\": "
+			<< options.warmup << ",\n  \"results\": [\n";
+	bool first = true;
+	for (const Scene &scene : SCENES) {
+		if (!options.scenes.empty()
+				&& std::find(options.scenes.begin(), options.scenes.end(),
+						scene.name) == options.scenes.end()) {
+			continue;
+		}
+		std::vector<long> counts = options.counts;
+		if (counts.empty()) {
+			counts.push_back(scene.defaultCount);
+		}
+		for (long count : counts) {
+			std::cerr << "running " << scene.name << " at " << count << "\n";
+			if (!first) {
+				std::cout << ",\n";
+			}
+			first = false;
+			runScene(scene, count, options, renderer, std::cout);
+		}
+	}
+	std::cout << "\n  ]\n}" << std::endl;
+
+	JobSystem::getInstance().shutDown();
+	if (renderer != nullptr) {
+		SDL_DestroyRenderer(renderer);
+	}
+	SDL_FreeSurface(target);
+	SDL_Quit();
+	return 0;
+}
@@ -0,0 +1,130 @@
+#include "base/AllocationTracker.hpp"
+#include <cstdlib>
+#include <new>
+#include <sstream>
+
+namespace {
+
+// the subsystem this thread's allocations count against
+thread_local AllocationTracker::Subsystem tSubsystem = AllocationTracker::OTHER;
+
+}
+
+std::atomic<std::size_t> AllocationTracker::sAllocations[SUBSYSTEM_COUNT];
+std::atomic<std::size_t> AllocationTracker::sBytes[SUBSYSTEM_COUNT];
+AllocationTracker::Counts AllocationTracker::sLastFrame;
+
+std::size_t AllocationTracker::Counts::totalAllocations() const {
+	std::size_t total = 0;
+	for (int i = 0; i < SUBSYSTEM_COUNT; i++) {
+		total += allocations[i];
+	}
+	return total;
+}
+
+std::size_t AllocationTracker::Counts::totalBytes() const {
+	std::size_t total = 0;
+	for (int i = 0; i < SUBSYSTEM_COUNT; i++) {
+		total += bytes[i];
+	}
+	return total;
+}
+
+std::string AllocationTracker::Counts::describe() const {
+	std::ostringstream text;
+	text << totalAllocations() << " (" << totalBytes() << " B)";
+	const char *separator = ": ";
+	for (int i = 0; i < SUBSYSTEM_COUNT; i++) {
+		if (allocations[i] > 0) {
+			text << separator << subsystemName(i) << " " << allocations[i]
+					<< " (" << bytes[i] << " B)";
+			separator = ", ";
+		}
+	}
+	return text.str();
+}
+
+bool AllocationTracker::enabled() {
+#ifdef ENGINE_ALLOC_TRACKING
+	return true;
+#else
+	return false;
+#endif
+}
+
+void AllocationTracker::record(std::size_t bytes) {
+	sAllocations[tSubsystem].fetch_add(1, std::memory_order_relaxed);
+	sBytes[tSubsystem].fetch_add(bytes, std::memory_order_relaxed);
+}
+
+void AllocationTracker::endFrame() {
+	for (int i = 0; i < SUBSYSTEM_COUNT; i++) {
+		sLastFrame.allocations[i] = sAllocations[i].exchange(0,
+				std::memory_order_relaxed);
+		sLastFrame.bytes[i] = sBytes[i].exchange(0, std::memory_order_relaxed);
+	}
+}
+
+const AllocationTracker::Counts &AllocationTracker::lastFrame() {
+	return sLastFrame;
+}
+
+const char *AllocationTracker::subsystemName(int subsystem) {
+	static const char *NAMES[SUBSYSTEM_COUNT] = { "other", "events", "spawn",
+			"gameplay", "physics", "postStep", "removal", "render", "workers" };
+	return NAMES[subsystem];
+}
+
+AllocationTracker::Scope::Scope(Subsystem subsystem) :
+		mPrevious(tSubsystem) {
+	tSubsystem = subsystem;
+}
+
+AllocationTracker::Scope::~Scope() {
+	tSubsystem = mPrevious;
+}
+
+#ifdef ENGINE_ALLOC_TRACKING
+
+// The replacements every new and delete in the program goes through.
+// malloc and free do the work; the array and nothrow forms forward here.
+
+void *operator new(std::size_t size) {
+	AllocationTracker::record(size);
+	void *memory = std::malloc(size > 0 ? size : 1);
+	if (memory == nullptr) {
+		throw std::bad_alloc();
+	}
+	return memory;
+}
+
+void *operator new[](std::size_t size) {
+	return operator new(size);
+}
+
+void *operator new(std::size_t size, const std::nothrow_t&) noexcept {
+	AllocationTracker::record(size);
+	return std::malloc(size > 0 ? size : 1);
+}
+
+void *operator new[](std::size_t size, const std::nothrow_t &nothrow) noexcept {
+	return operator new(size, nothrow);
+}
+
+void operator delete(void *memory) noexcept {
+	std::free(memory);
+}
+
+void operator delete[](void *memory) noexcept {
+	std::free(memory);
+}
+
+void operator delete(void *memory, const std::nothrow_t&) noexcept {
+	std::free(memory);
+}
+
+void operator delete[](void *memory, const std::nothrow_t&) noexcept {
+	std::free(memory);
+}
+
+#endif
@@ -0,0 +1,86 @@
+#ifndef BASE_ALLOCATION_TRACKER
+#define BASE_ALLOCATION_TRACKER
+
+#include <atomic>
+#include <cstddef>
+#include <string>
+
+//! \brief Counts heap allocations, and their bytes, per frame and per
+//! engine subsystem, to find the churn that makes frame times jitter.
+//!
+//! Built with ENGINE_ALLOC_TRACKING defined (see the Makefile), the global
+//! operator new is replaced by one that records each allocation against
+//! the calling thread's current subsystem.  Code names its subsystem with
+//! ALLOC_SCOPE(SUBSYSTEM) for the rest of the enclosing block, and the
+//! loop closes each frame with ALLOC_END_FRAME().  Without the define the
+//! macros compile to nothing and enabled() is false.
+class AllocationTracker {
+public:
+
+	//! Where an allocation was made.
+	enum Subsystem {
+		OTHER, //!< Outside any scope: loading, setup, the loop itself.
+		EVENTS, //!< Handling SDL events.
+		SPAWN, //!< Objects entering the level.
+		GAMEPLAY, //!< Component updates and win and lose checks.
+		PHYSICS, //!< The physics step and its contact callbacks.
+		POST_STEP, //!< Copying bodies back to objects.
+		REMOVAL, //!< Removing objects from the level.
+		RENDER, //!< Drawing the frame.
+		WORKERS, //!< Job system worker threads.
+		SUBSYSTEM_COUNT
+	};
+
+	//! Allocations made in a frame.
+	struct Counts {
+		std::size_t allocations[SUBSYSTEM_COUNT];
+		std::size_t bytes[SUBSYSTEM_COUNT];
+
+		std::size_t totalAllocations() const;
+		std::size_t totalBytes() const;
+		std::string describe() const; //!< e.g. "3 (96 B): gameplay 2 (64 B), render 1 (32 B)".
+	};
+
+	static bool enabled(); //!< Whether allocations are being counted at all.
+
+	static void record(std::size_t bytes); //!< Count an allocation against this thread's subsystem.
+	static void endFrame(); //!< Close the current frame's tally.
+
+	static const Counts &lastFrame(); //!< Allocations in the last finished frame.
+
+	static const char *subsystemName(int subsystem);
+
+	//! \brief Sets this thread's subsystem until it goes out of scope;
+	//! made by ALLOC_SCOPE.
+	class Scope {
+	public:
+		Scope(Subsystem subsystem);
+		~Scope();
+
+	private:
+		Scope(const Scope&) = delete;
+		void operator=(Scope const&) = delete;
+
+		Subsystem mPrevious;
+	};
+
+private:
+
+	static std::atomic<std::size_t> sAllocations[SUBSYSTEM_COUNT];
+	static std::atomic<std::size_t> sBytes[SUBSYSTEM_COUNT];
+	static Counts sLastFrame;
+
+};
+
+#define ALLOC_JOIN_(a, b) a##b
+#define ALLOC_JOIN(a, b) ALLOC_JOIN_(a, b)
+
+#ifdef ENGINE_ALLOC_TRACKING
+#define ALLOC_SCOPE(subsystem) AllocationTracker::Scope ALLOC_JOIN(allocScope, __LINE__)(AllocationTracker::subsystem)
+#define ALLOC_END_FRAME() AllocationTracker::endFrame()
+#else
+#define ALLOC_SCOPE(subsystem) ((void)0)
+#define ALLOC_END_FRAME() ((void)0)
+#endif
+
+#endif
@@ -0,0 +1,249 @@
+#include "base/AssetArchive.hpp"
+#include <cstdio>
+#include <cstring>
+#include <sys/stat.h>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+const char MAGIC[8] = {'A', 'S', 'S', 'E', 'T', 'P', 'K', '1'};
+
+// data is aligned so pixels and samples can be used where they lie
+const std::size_t DATA_ALIGNMENT = 16;
+
+std::size_t alignUp(std::size_t n, std::size_t alignment) {
+	return (n + alignment - 1) / alignment * alignment;
+}
+
+}
+
+const Uint32 AssetArchive::VERSION;
+
+AssetArchive::AssetArchive() {
+}
+
+AssetArchive::~AssetArchive() {
+	close();
+}
+
+bool AssetArchive::open(const std::string &path) {
+	close();
+#ifdef _WIN32
+	FILE *file = fopen(path.c_str(), "rb");
+	if (!file) {
+		return false;
+	}
+	struct stat info;
+	if (stat(path.c_str(), &info) == 0) {
+		mModified = info.st_mtime;
+	}
+	fseek(file, 0, SEEK_END);
+	long length = ftell(file);
+	fseek(file, 0, SEEK_SET);
+	if (length > 0) {
+		mBuffer.resize(length);
+		if (fread(mBuffer.data(), 1, length, file) == (std::size_t)length) {
+			mData = mBuffer.data();
+			mSize = length;
+		}
+	}
+	fclose(file);
+#else
+	int fd = ::open(path.c_str(), O_RDONLY);
+	if (fd < 0) {
+		return false;
+	}
+	struct stat info;
+	if (fstat(fd, &info) == 0 && info.st_size > 0) {
+		mModified = info.st_mtime;
+		// private and writable, so the loaders that want a non-const pointer
+		// can be given one; nothing written reaches the file
+		void *mapped = mmap(nullptr, info.st_size, PROT_READ | PROT_WRITE,
+				MAP_PRIVATE, fd, 0);
+		if (mapped != MAP_FAILED) {
+			mData = static_cast<Uint8*>(mapped);
+			mSize = info.st_size;
+		}
+	}
+	::close(fd);
+#endif
+	if (!mData) {
+		close();
+		return false;
+	}
+
+	// check everything the index points at lies in the file and fits its
+	// kind, so nothing read later can run off the end of the mapping
+	Header header;
+	if (mSize < sizeof(header)) {
+		close();
+		return false;
+	}
+	std::memcpy(&header, mData, sizeof(header));
+	if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0
+			|| header.version != VERSION
+			|| header.indexOffset % alignof(Entry) != 0
+			|| header.indexOffset > mSize
+			|| header.count > (mSize - header.indexOffset) / sizeof(Entry)) {
+		close();
+		return false;
+	}
+	const Entry *entries =
+			reinterpret_cast<const Entry*>(mData + header.indexOffset);
+	mIndex.reserve(header.count);
+	for (Uint32 i = 0; i < header.count; i++) {
+		const Entry &entry = entries[i];
+		if (!isValid(entry)) {
+			close();
+			return false;
+		}
+		const char *name =
+				reinterpret_cast<const char*>(mData + entry.nameOffset);
+		mIndex[std::string(name, entry.nameLength)] = &entry;
+	}
+	return true;
+}
+
+bool AssetArchive::isValid(const Entry &entry) const {
+	if (entry.offset > mSize || entry.size > mSize - entry.offset
+			|| entry.offset % DATA_ALIGNMENT != 0
+			|| entry.nameOffset > mSize
+			|| entry.nameLength > mSize - entry.nameOffset) {
+		return false;
+	}
+	switch (entry.kind) {
+	case RAW:
+		return true;
+	case IMAGE: {
+		// width, height, pitch and pixel format, as a surface is made from
+		Uint64 w = entry.params[0], h = entry.params[1];
+		Uint64 pitch = entry.params[2];
+		Uint32 format = entry.params[3];
+		if (w == 0 || h == 0 || SDL_ISPIXELFORMAT_FOURCC(format)
+				|| SDL_BYTESPERPIXEL(format) == 0) {
+			return false;
+		}
+		return pitch >= w * SDL_BYTESPERPIXEL(format)
+				&& pitch * h <= entry.size;
+	}
+	case SOUND: {
+		// frequency, audio format and channels; whole frames only
+		Uint64 frameSize = Uint64(entry.params[2])
+				* (SDL_AUDIO_BITSIZE(entry.params[1]) / 8);
+		return entry.params[0] != 0 && frameSize != 0
+				&& entry.size % frameSize == 0;
+	}
+	default:
+		return false;
+	}
+}
+
+void AssetArchive::close() {
+	mIndex.clear();
+#ifdef _WIN32
+	mBuffer.clear();
+	mBuffer.shrink_to_fit();
+#else
+	if (mData) {
+		munmap(mData, mSize);
+	}
+#endif
+	mData = nullptr;
+	mSize = 0;
+	mModified = 0;
+}
+
+const AssetArchive::Entry *AssetArchive::find(const std::string &name) const {
+	auto it = mIndex.find(normalize(name));
+	return it != mIndex.end() ? it->second : NULL;
+}
+
+bool AssetArchive::isOlderThan(const std::string &path) const {
+	struct stat info;
+	return stat(path.c_str(), &info) == 0 && info.st_mtime > mModified;
+}
+
+std::string AssetArchive::normalize(const std::string &name) {
+	std::string normal = name;
+	for (char &c : normal) {
+		if (c == '\\') {
+			c = '/';
+		}
+	}
+	std::size_t start = 0;
+	for (;;) {
+		if (normal.compare(start, 2, "./") == 0) {
+			start += 2;
+		} else if (normal.compare(start, 1, "/") == 0) {
+			start += 1;
+		} else {
+			break;
+		}
+	}
+	return normal.substr(start);
+}
+
+void AssetArchive::Builder::add(const std::string &name, Kind kind,
+		const Uint32 *params, const void *data, std::size_t size) {
+	Entry entry = {};
+	entry.offset = alignUp(mData.size(), DATA_ALIGNMENT);
+	entry.size = size;
+	entry.kind = kind;
+	if (params) {
+		std::memcpy(entry.params, params, sizeof(entry.params));
+	}
+	mData.resize(entry.offset + size);
+	if (size > 0) {
+		std::memcpy(mData.data() + entry.offset, data, size);
+	}
+	mEntries.push_back(entry);
+	mNames.push_back(normalize(name));
+}
+
+// The header, then the data, then the names, then the index, so the index
+// can be written once every offset is known
+bool AssetArchive::Builder::save(const std::string &path) const {
+	std::size_t dataStart = alignUp(sizeof(Header), DATA_ALIGNMENT);
+	std::size_t namesStart = dataStart + mData.size();
+	std::string names;
+	std::vector<Entry> entries = mEntries;
+	for (std::size_t i = 0; i < entries.size(); i++) {
+		entries[i].offset += dataStart;
+		entries[i].nameOffset = namesStart + names.size();
+		entries[i].nameLength = mNames[i].size();
+		names += mNames[i];
+	}
+	std::size_t indexStart =
+			alignUp(namesStart + names.size(), alignof(Entry));
+
+	Header header = {};
+	std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+	header.version = VERSION;
+	header.count = entries.size();
+	header.indexOffset = indexStart;
+
+	std::vector<Uint8> out(indexStart + entries.size() * sizeof(Entry), 0);
+	std::memcpy(out.data(), &header, sizeof(header));
+	if (!mData.empty()) {
+		std::memcpy(out.data() + dataStart, mData.data(), mData.size());
+	}
+	if (!names.empty()) {
+		std::memcpy(out.data() + namesStart, names.data(), names.size());
+	}
+	if (!entries.empty()) {
+		std::memcpy(out.data() + indexStart, entries.data(),
+				entries.size() * sizeof(Entry));
+	}
+
+	FILE *file = fopen(path.c_str(), "wb");
+	if (!file) {
+		return false;
+	}
+	bool written = fwrite(out.data(), 1, out.size(), file) == out.size();
+	return fclose(file) == 0 && written;
+}
@@ -0,0 +1,144 @@
+#ifndef BASE_ASSET_ARCHIVE
+#define BASE_ASSET_ARCHIVE
+
+#include <SDL.h>
+#include <cstddef>
+#include <ctime>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+//! \brief Many assets in one file, made ahead of time by the packer
+//! (src/packer), mapped into memory and read where they lie.
+//!
+//! Images are stored decoded, in a pixel format SDL's renderers take as
+//! it is; sounds as samples already in the mixer's format; anything else,
+//! such as levels, text, fonts and music, as the file's bytes.  An index
+//! at the end finds each by the name it was packed under, the path under
+//! the resource directory.  Numbers are in the byte order of the machine
+//! that packed them, so an archive is made for the machines it ships to.
+class AssetArchive {
+public:
+
+	//! How an entry's data is stored.
+	enum Kind {
+		RAW, //!< The file as it was.
+		IMAGE, //!< Pixels; params are width, height, pitch and pixel format.
+		SOUND //!< Samples; params are frequency, audio format and channels.
+	};
+
+	static const Uint32 VERSION = 1; //!< Format written, and the only one read.
+
+	//! An entry in the index.
+	struct Entry {
+		Uint64 offset; //!< Of the data, from the start of the archive.
+		Uint64 size; //!< Of the data, in bytes.
+		Uint32 kind;
+		Uint32 nameOffset; //!< Of the name, from the start of the archive.
+		Uint32 nameLength;
+		Uint32 params[4]; //!< Depend on the kind.
+		Uint32 reserved;
+	};
+
+	AssetArchive();
+	~AssetArchive();
+
+	/**
+	 * Map an archive into memory, closing any open one.  Returns false,
+	 * leaving none open, if it cannot be read or is not an archive, or
+	 * if any entry lies outside it or does not fit its kind.
+	 * @param const std::string& path: the archive's path
+	 */
+	bool open(const std::string &path);
+
+	//! Unmap the archive; what was read from it must no longer be used.
+	void close();
+
+	//! Whether an archive is open.
+	inline bool isOpen() const { return mData != nullptr; }
+
+	/**
+	 * Return an entry, or NULL if the archive has none by that name or
+	 * none is open.  Safe to call from any thread while the archive is
+	 * open.
+	 * @param const std::string& name: the asset's path under the resources
+	 */
+	const Entry *find(const std::string &name) const;
+
+	/**
+	 * Whether a file was changed after the archive was made, so what the
+	 * archive holds of it is out of date.  False if the file is missing.
+	 * @param const std::string& path: the file's path
+	 */
+	bool isOlderThan(const std::string &path) const;
+
+	/**
+	 * Return an entry's data.  The mapping is private, so writing to it
+	 * changes only this process's copy of the pages written.
+	 */
+	inline Uint8 *data(const Entry &entry) const {
+		return mData + entry.offset;
+	}
+
+	/**
+	 * Return the name an asset is packed and found under: its path with
+	 * any leading "/" or "./" taken off and '/' as the separator
+	 */
+	static std::string normalize(const std::string &name);
+
+	//! \brief Collects entries and writes them out as an archive.
+	class Builder {
+	public:
+
+		/**
+		 * Add an entry
+		 * @param const std::string& name: found under its normalized form
+		 * @param Kind kind: how the data is stored
+		 * @param const Uint32* params: four numbers for the kind, or NULL
+		 * @param const void* data, std::size_t size: the data
+		 */
+		void add(const std::string &name, Kind kind, const Uint32 *params,
+				const void *data, std::size_t size);
+
+		/**
+		 * Write the archive; false if it could not be
+		 * @param const std::string& path: where to
+		 */
+		bool save(const std::string &path) const;
+
+		//! Entries added.
+		inline std::size_t count() const { return mEntries.size(); }
+
+	private:
+
+		std::vector<Entry> mEntries; // offsets from the start of the data
+		std::vector<std::string> mNames;
+		std::vector<Uint8> mData;
+	};
+
+private:
+
+	AssetArchive(const AssetArchive&) = delete;
+	void operator=(AssetArchive const&) = delete;
+
+	//! At the start of the archive.
+	struct Header {
+		char magic[8];
+		Uint32 version;
+		Uint32 count; // entries in the index
+		Uint64 indexOffset;
+	};
+
+	bool isValid(const Entry &entry) const;
+
+	Uint8 *mData = nullptr;
+	std::size_t mSize = 0;
+	std::time_t mModified = 0;
+#ifdef _WIN32
+	std::vector<Uint8> mBuffer; // the archive, read in whole
+#endif
+	std::unordered_map<std::string, const Entry*> mIndex;
+
+};
+
+#endif
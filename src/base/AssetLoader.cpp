@@ -0,0 +1,85 @@
+#include "base/AssetLoader.hpp"
+#include <algorithm>
+
+namespace {
+
+// used when the core count cannot be found
+const unsigned DEFAULT_THREADS = 4;
+
+}
+
+AssetLoader::AssetLoader() {
+}
+
+AssetLoader::~AssetLoader() {
+	wait();
+}
+
+// A thread is added only when none is idle to take the job, so a batch of
+// small files does not start more threads than it keeps busy
+void AssetLoader::post(std::function<void()> job) {
+	std::lock_guard<std::mutex> lock(mMutex);
+	mJobs.push_back(job);
+	mPosted++;
+	unsigned cores = std::thread::hardware_concurrency();
+	std::size_t maxThreads = cores > 0 ? cores : DEFAULT_THREADS;
+	if (mIdle < mJobs.size() && mThreads.size() < maxThreads) {
+		mThreads.push_back(std::thread(&AssetLoader::workerLoop, this));
+	}
+	mWake.notify_one();
+}
+
+std::size_t AssetLoader::posted() {
+	std::lock_guard<std::mutex> lock(mMutex);
+	return mPosted;
+}
+
+std::size_t AssetLoader::finished() {
+	std::lock_guard<std::mutex> lock(mMutex);
+	return mFinished;
+}
+
+std::size_t AssetLoader::waitForMore(std::size_t seen) {
+	std::unique_lock<std::mutex> lock(mMutex);
+	mProgress.wait(lock, [this, seen]() {
+		return mFinished > seen || mFinished == mPosted;
+	});
+	return mFinished;
+}
+
+void AssetLoader::wait() {
+	{
+		std::unique_lock<std::mutex> lock(mMutex);
+		mProgress.wait(lock, [this]() { return mFinished == mPosted; });
+		mStopping = true;
+	}
+	mWake.notify_all();
+	for (auto &thread : mThreads) {
+		thread.join();
+	}
+	std::lock_guard<std::mutex> lock(mMutex);
+	mThreads.clear();
+	mPosted = 0;
+	mFinished = 0;
+	mIdle = 0;
+	mStopping = false;
+}
+
+void AssetLoader::workerLoop() {
+	std::unique_lock<std::mutex> lock(mMutex);
+	for (;;) {
+		mIdle++;
+		mWake.wait(lock, [this]() { return !mJobs.empty() || mStopping; });
+		mIdle--;
+		if (mJobs.empty()) {
+			return;
+		}
+		std::function<void()> job = std::move(mJobs.front());
+		mJobs.pop_front();
+		lock.unlock();
+		job();
+		lock.lock();
+		mFinished++;
+		mProgress.notify_all();
+	}
+}
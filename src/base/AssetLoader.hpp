@@ -0,0 +1,62 @@
+#ifndef BASE_ASSET_LOADER
+#define BASE_ASSET_LOADER
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//! \brief A few threads that run load jobs from a queue, for the
+//! ResourceManager's asynchronous loads.
+//!
+//! Threads are started as jobs are posted, up to one per core and never
+//! more than there are jobs waiting, and end once wait has seen every job
+//! finish; a loader that is not loading holds no threads.  Jobs run in any
+//! order, so each must write only to places no other job touches.
+class AssetLoader {
+public:
+
+	AssetLoader();
+	~AssetLoader();
+
+	/**
+	 * Queue a job and return at once
+	 * @param std::function<void()> job: the load to run
+	 */
+	void post(std::function<void()> job);
+
+	std::size_t posted(); //!< Jobs posted since the last wait returned.
+	std::size_t finished(); //!< Of those, the ones finished.
+
+	/**
+	 * Block until more jobs have finished than seen, or all have, and
+	 * return how many have
+	 * @param std::size_t seen: the finished count last returned
+	 */
+	std::size_t waitForMore(std::size_t seen);
+
+	void wait(); //!< Block until every job posted has finished, then end the threads.
+
+private:
+
+	AssetLoader(const AssetLoader&) = delete;
+	void operator=(AssetLoader const&) = delete;
+
+	void workerLoop();
+
+	std::vector<std::thread> mThreads;
+	std::deque<std::function<void()>> mJobs;
+	std::mutex mMutex;
+	std::condition_variable mWake; // a job was posted, or stop
+	std::condition_variable mProgress; // a job finished
+	std::size_t mPosted = 0;
+	std::size_t mFinished = 0;
+	std::size_t mIdle = 0; // threads waiting for a job
+	bool mStopping = false;
+
+};
+
+#endif
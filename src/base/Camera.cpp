@@ -0,0 +1,43 @@
+#include "base/Camera.hpp"
+#include "base/GameObject.hpp"
+#include <algorithm>
+
+Camera::Camera() {
+}
+
+void Camera::setViewport(float w, float h) {
+	mW = w;
+	mH = h;
+	moveTo(mX, mY);
+}
+
+void Camera::setBounds(float w, float h) {
+	mBoundsW = w;
+	mBoundsH = h;
+	moveTo(mX, mY);
+}
+
+void Camera::follow(const std::shared_ptr<GameObject> &target) {
+	mTarget = target;
+}
+
+void Camera::moveTo(float x, float y) {
+	mX = std::max(0.0f, std::min(x, mBoundsW - mW));
+	mY = std::max(0.0f, std::min(y, mBoundsH - mH));
+}
+
+void Camera::setPosition(float x, float y) {
+	mX = x;
+	mY = y;
+}
+
+// Following the render position rather than the physics one keeps the
+// target still on screen between steps
+void Camera::update() {
+	std::shared_ptr<GameObject> target = mTarget.lock();
+	if (!target || !target->isActive()) {
+		return;
+	}
+	moveTo(target->renderX() + 0.5f * (target->w() - mW),
+			target->renderY() + 0.5f * (target->h() - mH));
+}
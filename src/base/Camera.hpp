@@ -0,0 +1,57 @@
+#ifndef BASE_CAMERA
+#define BASE_CAMERA
+
+#include <memory>
+
+class GameObject;
+
+//! \brief The part of a level shown in the window.  Follows a target,
+//! kept inside the level's bounds, and maps level coordinates to screen
+//! coordinates for the render components.
+class Camera {
+public:
+
+	Camera();
+
+	/**
+	 * Set the size of the view, usually the window's
+	 * @param float w, float h: width and height in level coordinates
+	 */
+	void setViewport(float w, float h);
+
+	/**
+	 * Set the size of the world the view stays inside, from 0, 0; the
+	 * view is never moved off it where it is larger than the view
+	 * @param float w, float h: width and height of the world
+	 */
+	void setBounds(float w, float h);
+
+	/**
+	 * Keep an object in the middle of the view, as far as the bounds allow,
+	 * until it leaves its level or another is followed
+	 * @param const std::shared_ptr<GameObject>& target: the object, or nullptr to stop
+	 */
+	void follow(const std::shared_ptr<GameObject> &target);
+
+	void moveTo(float x, float y); //!< Put the view's top left at x, y, within the bounds.
+	void setPosition(float x, float y); //!< Put the view's top left at x, y, wherever that is, e.g. to draw off screen.
+	void update(); //!< Move to the target's render position; called each frame before drawing.
+
+	inline float x() const { return mX; }
+	inline float y() const { return mY; }
+	inline float w() const { return mW; }
+	inline float h() const { return mH; }
+
+	inline float toScreenX(float x) const { return x - mX; } //!< Screen position of a level x.
+	inline float toScreenY(float y) const { return y - mY; } //!< Screen position of a level y.
+
+private:
+
+	float mX = 0, mY = 0;
+	float mW = 0, mH = 0;
+	float mBoundsW = 0, mBoundsH = 0;
+	std::weak_ptr<GameObject> mTarget;
+
+};
+
+#endif
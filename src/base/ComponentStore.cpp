@@ -0,0 +1,105 @@
+#include "base/ComponentStore.hpp"
+#include "base/PhysicsComponent.hpp"
+#include "base/PhysicsManager.hpp"
+
+const ComponentStore::Slot ComponentStore::INVALID_SLOT = static_cast<Slot>(-1);
+const std::size_t ComponentStore::NOT_POOLED = static_cast<std::size_t>(-1);
+
+ComponentStore::ComponentStore() {
+}
+
+ComponentStore::~ComponentStore() {
+}
+
+// Reuse a released slot if there is one, otherwise grow the arrays
+ComponentStore::Slot ComponentStore::allocate(GameObject &owner, float x,
+		float y, float w, float h) {
+	Slot slot;
+	if (!mFreeSlots.empty()) {
+		slot = mFreeSlots.back();
+		mFreeSlots.pop_back();
+		mX[slot] = x;
+		mY[slot] = y;
+		mPrevX[slot] = x;
+		mPrevY[slot] = y;
+		mW[slot] = w;
+		mH[slot] = h;
+		mOwners[slot] = &owner;
+	} else {
+		slot = mOwners.size();
+		mX.push_back(x);
+		mY.push_back(y);
+		mPrevX.push_back(x);
+		mPrevY.push_back(y);
+		mW.push_back(w);
+		mH.push_back(h);
+		mOwners.push_back(&owner);
+		mActive.push_back(0);
+		mPhysicsIndex.push_back(NOT_POOLED);
+		// room to release every slot, so releasing never allocates
+		mFreeSlots.reserve(mOwners.capacity());
+	}
+	mActive[slot] = 0;
+	return slot;
+}
+
+void ComponentStore::release(Slot slot) {
+	deactivate(slot);
+	mOwners[slot] = nullptr;
+	mFreeSlots.push_back(slot);
+}
+
+void ComponentStore::activate(Slot slot) {
+	mActive[slot] = 1;
+}
+
+void ComponentStore::deactivate(Slot slot) {
+	removePhysics(slot);
+	mActive[slot] = 0;
+}
+
+void ComponentStore::setPhysicsComponent(Slot slot, PhysicsComponent *comp) {
+	if (!mActive[slot]) {
+		return;
+	}
+	if (comp == nullptr) {
+		removePhysics(slot);
+	} else if (mPhysicsIndex[slot] != NOT_POOLED) {
+		mPhysics[mPhysicsIndex[slot]].body = comp->getBody();
+	} else {
+		mPhysicsIndex[slot] = mPhysics.size();
+		PhysicsEntry entry = { comp->getBody(), slot };
+		mPhysics.push_back(entry);
+	}
+}
+
+void ComponentStore::removePhysics(Slot slot) {
+	std::size_t index = mPhysicsIndex[slot];
+	if (index == NOT_POOLED) {
+		return;
+	}
+	mPhysics[index] = mPhysics.back();
+	mPhysicsIndex[mPhysics[index].slot] = index;
+	mPhysics.pop_back();
+	mPhysicsIndex[slot] = NOT_POOLED;
+}
+
+void ComponentStore::savePrevious() {
+	for (std::size_t i = 0; i < mPhysics.size(); i++) {
+		Slot slot = mPhysics[i].slot;
+		mPrevX[slot] = mX[slot];
+		mPrevY[slot] = mY[slot];
+	}
+}
+
+// Write body positions straight into the transform arrays
+void ComponentStore::postStep() {
+	for (std::size_t i = 0; i < mPhysics.size(); i++) {
+		const PhysicsEntry &entry = mPhysics[i];
+		b2Vec2 position = entry.body->GetPosition();
+		mX[entry.slot] = position.x / PhysicsManager::GAME_TO_PHYSICS_SCALE
+				- 0.5f * mW[entry.slot];
+		mY[entry.slot] = position.y / PhysicsManager::GAME_TO_PHYSICS_SCALE
+				- 0.5f * mH[entry.slot];
+	}
+}
@@ -0,0 +1,106 @@
+#ifndef BASE_COMPONENT_STORE
+#define BASE_COMPONENT_STORE
+
+#include <cstddef>
+#include <vector>
+
+class GameObject;
+class PhysicsComponent;
+class b2Body;
+
+//! \brief Structure-of-arrays storage for the per-object data that the
+//! level touches every frame.
+//!
+//! Transforms live in parallel arrays indexed by a slot that the game
+//! object keeps for its whole lifetime.  The Box2D bodies of the objects
+//! currently in the level are listed densely with their slots, so postStep
+//! reads each body directly instead of going through its object and its
+//! physics component.  Render components are not pooled; the level draws
+//! through its spatial grid, which culls to the camera.  Game objects act
+//! as thin handles onto this storage when a level enables it.  Generic
+//! components are batched by type in the level's ComponentRegistry
+//! instead.
+class ComponentStore {
+public:
+
+	typedef std::size_t Slot;
+
+	static const Slot INVALID_SLOT; //!< Slot of an object that is not stored.
+
+	ComponentStore();
+	~ComponentStore();
+
+	/**
+	 * Allocate a transform slot for a newly created object
+	 * @param GameObject& owner: the object that owns the slot
+	 */
+	Slot allocate(GameObject &owner, float x, float y, float w, float h);
+
+	/**
+	 * Release a slot when its object is destroyed
+	 * @param Slot slot: the slot to release
+	 */
+	void release(Slot slot);
+
+	/**
+	 * Mark a slot as part of the level; physics components set on it from
+	 * now on are put in the dense pool
+	 */
+	void activate(Slot slot);
+
+	/**
+	 * Take the slot's physics link out of the dense pool
+	 */
+	void deactivate(Slot slot);
+
+	void setPhysicsComponent(Slot slot, PhysicsComponent *comp); //!< Replace the physics link of a slot.
+
+	void savePrevious(); //!< Remember the positions of pooled physics objects before a step.
+	void postStep(); //!< Copy physics positions into the transform arrays.
+
+	inline float x(Slot slot) const { return mX[slot]; }
+	inline float y(Slot slot) const { return mY[slot]; }
+	inline float w(Slot slot) const { return mW[slot]; }
+	inline float h(Slot slot) const { return mH[slot]; }
+	inline float previousX(Slot slot) const { return mPrevX[slot]; } //!< x before the last physics step.
+	inline float previousY(Slot slot) const { return mPrevY[slot]; } //!< y before the last physics step.
+
+	inline void setX(Slot slot, float x) { mX[slot] = x; }
+	inline void setY(Slot slot, float y) { mY[slot] = y; }
+
+	inline bool isActive(Slot slot) const { return mActive[slot] != 0; }
+
+	inline std::size_t slotCount() const { return mOwners.size() - mFreeSlots.size(); } //!< Number of slots in use.
+
+private:
+
+	ComponentStore(const ComponentStore&) = delete;
+	void operator=(ComponentStore const&) = delete;
+
+	static const std::size_t NOT_POOLED; //!< Pool index of a link that is not pooled.
+
+	//! A pooled physics link: a component's body, which it keeps for its
+	//! lifetime, with the slot whose transform it writes.
+	struct PhysicsEntry {
+		b2Body *body;
+		Slot slot;
+	};
+
+	void removePhysics(Slot slot);
+
+	// transforms, indexed by slot
+	std::vector<float> mX, mY, mW, mH;
+	std::vector<float> mPrevX, mPrevY;
+	std::vector<GameObject*> mOwners;
+	std::vector<char> mActive;
+	std::vector<Slot> mFreeSlots;
+
+	// position of each slot's link in the dense pool
+	std::vector<std::size_t> mPhysicsIndex;
+
+	// dense pool of the active objects' bodies
+	std::vector<PhysicsEntry> mPhysics;
+
+};
+
+#endif
@@ -0,0 +1,126 @@
+#include "base/ComponentSystem.hpp"
+#include "base/JobSystem.hpp"
+#include "base/Level.hpp"
+
+const std::size_t ComponentSystem::NOT_REGISTERED = static_cast<std::size_t>(-1);
+const std::size_t ComponentRegistry::PARALLEL_GRAIN = 64;
+
+ComponentSystem::ComponentSystem(const ComponentType &type) :
+		mType(type) {
+}
+
+ComponentSystem::~ComponentSystem() {
+	for (std::size_t i = 0; i < mComponents.size(); i++) {
+		mComponents[i]->mSystemIndex = NOT_REGISTERED;
+	}
+}
+
+void ComponentSystem::add(GenericComponent &comp) {
+	if (comp.mSystemIndex != NOT_REGISTERED) {
+		return;
+	}
+	comp.mSystemIndex = mComponents.size();
+	mComponents.push_back(&comp);
+}
+
+// Swap the last component into the hole left by this one
+void ComponentSystem::remove(GenericComponent &comp) {
+	std::size_t index = comp.mSystemIndex;
+	if (index == NOT_REGISTERED) {
+		return;
+	}
+	GenericComponent *last = mComponents.back();
+	mComponents[index] = last;
+	last->mSystemIndex = index;
+	mComponents.pop_back();
+	comp.mSystemIndex = NOT_REGISTERED;
+}
+
+ComponentRegistry::ComponentRegistry() {
+}
+
+ComponentRegistry::~ComponentRegistry() {
+}
+
+void ComponentRegistry::add(GenericComponent &comp) {
+	systemFor(*comp.mType).add(comp);
+}
+
+void ComponentRegistry::remove(GenericComponent &comp) {
+	auto it = mSystemsByType.find(comp.mType);
+	if (it != mSystemsByType.end()) {
+		it->second->remove(comp);
+	}
+}
+
+// One virtual call per system; each system's own loop is non-virtual.
+// Systems made while this runs are held back until the loop is done, as
+// inserting them would move the systems still to run.
+void ComponentRegistry::update(Level &level) {
+	bool threaded = JobSystem::getInstance().threadCount() > 1;
+	mUpdating = true;
+	for (std::size_t i = 0; i < mSystems.size(); i++) {
+		ComponentSystem &system = *mSystems[i];
+		if (system.size() == 0) {
+			continue;
+		}
+		if (threaded && system.type().parallel()
+				&& system.size() > PARALLEL_GRAIN) {
+			updateParallel(system, level);
+		} else {
+			system.update(level, 0, system.size());
+		}
+	}
+	mUpdating = false;
+	for (auto &system : mNewSystems) {
+		insertSystem(std::move(system));
+	}
+	mNewSystems.clear();
+}
+
+// Run a batch in chunks, each recording its adds and removes into its own
+// buffer, then apply the buffers in chunk order
+void ComponentRegistry::updateParallel(ComponentSystem &system, Level &level) {
+	std::size_t chunks = JobSystem::chunkCount(system.size(), PARALLEL_GRAIN);
+	while (mCommandBuffers.size() < chunks) {
+		mCommandBuffers.push_back(
+				std::unique_ptr<LevelCommandBuffer>(new LevelCommandBuffer()));
+	}
+	JobSystem::getInstance().parallelFor(system.size(), PARALLEL_GRAIN,
+			[&](std::size_t begin, std::size_t end, std::size_t chunk) {
+				Level::setThreadCommandBuffer(mCommandBuffers[chunk].get());
+				system.update(level, begin, end);
+				Level::setThreadCommandBuffer(nullptr);
+			});
+	for (std::size_t chunk = 0; chunk < chunks; chunk++) {
+		level.applyCommands(*mCommandBuffers[chunk]);
+	}
+}
+
+// Find the system of a type, making one if this is the first component of
+// that type
+ComponentSystem & ComponentRegistry::systemFor(const ComponentType &type) {
+	auto it = mSystemsByType.find(&type);
+	if (it != mSystemsByType.end()) {
+		return *it->second;
+	}
+	ComponentSystem *system = type.createSystem(type);
+	mSystemsByType[&type] = system;
+	if (mUpdating) {
+		mNewSystems.push_back(std::unique_ptr<ComponentSystem>(system));
+	} else {
+		insertSystem(std::unique_ptr<ComponentSystem>(system));
+	}
+	return *system;
+}
+
+// New systems go after every system of the same or an earlier phase, so
+// types keep the order in which they were first seen
+void ComponentRegistry::insertSystem(std::unique_ptr<ComponentSystem> system) {
+	std::size_t position = mSystems.size();
+	while (position > 0
+			&& mSystems[position - 1]->type().phase > system->type().phase) {
+		position--;
+	}
+	mSystems.insert(mSystems.begin() + position, std::move(system));
+}
@@ -0,0 +1,148 @@
+#ifndef BASE_COMPONENT_SYSTEM
+#define BASE_COMPONENT_SYSTEM
+
+#include "base/GenericComponent.hpp"
+#include <cstddef>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+class ComponentSystem;
+class Level;
+struct LevelCommandBuffer;
+
+//! \brief Describes a concrete generic component type: its update phase and
+//! how to make the system that updates it.  There is one per type, so its
+//! address identifies the type.
+struct ComponentType {
+	ComponentSystem *(*createSystem)(const ComponentType &type);
+	int phase;
+	unsigned reads, writes; //!< GenericComponent::Access masks.
+
+	//! Whether the components of this type can update concurrently.
+	inline bool parallel() const {
+		return (writes & ~GenericComponent::ACCESS_OWNER) == 0
+				&& (reads & GenericComponent::ACCESS_OBJECTS) == 0;
+	}
+
+	template<typename T>
+	static const ComponentType & of();
+};
+
+//! \brief Updates every component of one concrete type in one batch.
+class ComponentSystem {
+public:
+
+	static const std::size_t NOT_REGISTERED; //!< System index of a component in no system.
+
+	ComponentSystem(const ComponentType &type);
+	virtual ~ComponentSystem();
+
+	//! Update the components in [begin, end) of the batch.
+	virtual void update(Level &level, std::size_t begin, std::size_t end) = 0;
+
+	void add(GenericComponent &comp); //!< Add a component to the batch.
+	void remove(GenericComponent &comp); //!< Remove a component, moving the last one into its place.
+
+	inline const ComponentType & type() const { return mType; }
+	inline std::size_t size() const { return mComponents.size(); }
+
+protected:
+
+	std::vector<GenericComponent*> mComponents;
+
+private:
+
+	ComponentSystem(const ComponentSystem&) = delete;
+	void operator=(ComponentSystem const&) = delete;
+
+	const ComponentType &mType;
+
+};
+
+//! \brief The system for components of type T.  Its loop calls T::update
+//! directly, so there is no virtual dispatch per component.
+template<typename T>
+class TypedComponentSystem: public ComponentSystem {
+public:
+
+	TypedComponentSystem(const ComponentType &type) :
+			ComponentSystem(type) {
+	}
+
+	virtual void update(Level &level, std::size_t begin, std::size_t end)
+			override {
+		for (std::size_t i = begin; i < end; i++) {
+			static_cast<T*>(mComponents[i])->T::update(level);
+		}
+	}
+
+	static ComponentSystem * create(const ComponentType &type) {
+		return new TypedComponentSystem<T>(type);
+	}
+
+};
+
+//! Components added through a GenericComponent pointer, or through a
+//! pointer to a base of their type, go here, as T::update would skip
+//! their override; their system falls back to virtual calls.
+template<>
+inline void TypedComponentSystem<GenericComponent>::update(Level &level,
+		std::size_t begin, std::size_t end) {
+	for (std::size_t i = begin; i < end; i++) {
+		mComponents[i]->update(level);
+	}
+}
+
+template<typename T>
+const ComponentType & ComponentType::of() {
+	static const ComponentType type = { &TypedComponentSystem<T>::create,
+			T::PHASE, T::READS, T::WRITES };
+	return type;
+}
+
+//! \brief The systems of a level, one per component type.  Systems run in
+//! phase order, and within a phase in the order their type was first seen,
+//! so the update order is deterministic.  A system made during an update
+//! joins the others once it ends, as components added during a batch wait
+//! for the next one.
+//!
+//! With more than one job system thread, the batches of parallel types are
+//! split into fixed-size chunks that run concurrently.  Objects added or
+//! removed by a chunk go to that chunk's command buffer, and the buffers
+//! are applied in chunk order once the batch is done, so the outcome does
+//! not depend on the number of threads.  With one thread nothing is
+//! buffered and every batch runs in order on the caller.
+class ComponentRegistry {
+public:
+
+	static const std::size_t PARALLEL_GRAIN; //!< Components per chunk of a parallel batch.
+
+	ComponentRegistry();
+	~ComponentRegistry();
+
+	void add(GenericComponent &comp); //!< Add a component to its type's system.
+	void remove(GenericComponent &comp); //!< Remove a component from its type's system.
+
+	void update(Level &level); //!< Run every system.
+
+	inline std::size_t systemCount() const { return mSystems.size() + mNewSystems.size(); }
+
+private:
+
+	ComponentRegistry(const ComponentRegistry&) = delete;
+	void operator=(ComponentRegistry const&) = delete;
+
+	ComponentSystem & systemFor(const ComponentType &type);
+	void insertSystem(std::unique_ptr<ComponentSystem> system);
+	void updateParallel(ComponentSystem &system, Level &level);
+
+	std::vector<std::unique_ptr<ComponentSystem>> mSystems;
+	std::unordered_map<const ComponentType*, ComponentSystem*> mSystemsByType;
+	std::vector<std::unique_ptr<ComponentSystem>> mNewSystems; // made during update
+	bool mUpdating = false;
+	std::vector<std::unique_ptr<LevelCommandBuffer>> mCommandBuffers; // one per chunk
+
+};
+
+#endif
@@ -0,0 +1,120 @@
+#include "base/DrawList.hpp"
+
+namespace {
+
+// Sort key, high bits first: the layer, whether the draw is a sprite, the
+// sprite's texture and the rectangle's colour
+const int LAYER_SHIFT = 56;
+const Uint64 SPRITE_BIT = Uint64(1) << 55;
+const int TEXTURE_SHIFT = 32;
+const Uint64 TEXTURE_IDS = Uint64(1) << 23;
+
+}
+
+DrawList::DrawList() {
+}
+
+void DrawList::begin() {
+	mCommands.clear();
+	mEntries.clear();
+}
+
+void DrawList::fill(Uint8 layer, const SDL_Rect &rect, SDL_Color color) {
+	Command command = { nullptr, rect, { 0, 0, 0, 0 }, color };
+	Entry entry = { Uint64(layer) << LAYER_SHIFT
+			| Uint64(color.r) << 24 | Uint64(color.g) << 16
+			| Uint64(color.b) << 8 | Uint64(color.a),
+			Uint32(mCommands.size()) };
+	mCommands.push_back(command);
+	mEntries.push_back(entry);
+}
+
+void DrawList::draw(Uint8 layer, const Sprite &sprite, const SDL_FRect &dest) {
+	if (sprite.texture == nullptr) {
+		return;
+	}
+	const SDL_Color white = { 0xFF, 0xFF, 0xFF, 0xFF };
+	Command command = { sprite.texture, sprite.source, dest, white };
+	Entry entry = { Uint64(layer) << LAYER_SHIFT | SPRITE_BIT
+			| textureKey(sprite.texture) << TEXTURE_SHIFT,
+			Uint32(mCommands.size()) };
+	mCommands.push_back(command);
+	mEntries.push_back(entry);
+}
+
+// Textures are numbered as they are first seen.  Should the numbers run
+// out they start again, which only costs some batching
+Uint64 DrawList::textureKey(SDL_Texture *texture) {
+	auto found = mTextureIds.find(texture);
+	if (found != mTextureIds.end()) {
+		return found->second;
+	}
+	if (mTextureIds.size() == TEXTURE_IDS) {
+		mTextureIds.clear();
+	}
+	Uint64 id = mTextureIds.size();
+	mTextureIds[texture] = id;
+	return id;
+}
+
+// Least significant digit radix sort, a byte at a time, which keeps draws
+// with equal keys in order.  All eight histograms are counted in one pass,
+// and bytes every key shares, such as the layer in a one-layer level, are
+// skipped
+void DrawList::sort() {
+	const std::size_t count = mEntries.size();
+	if (count < 2) {
+		return;
+	}
+	std::size_t histograms[8][256] = { };
+	for (const Entry &entry : mEntries) {
+		for (int digit = 0; digit < 8; digit++) {
+			histograms[digit][(entry.key >> (digit * 8)) & 0xFF]++;
+		}
+	}
+	mScratch.resize(count);
+	for (int digit = 0; digit < 8; digit++) {
+		const int shift = digit * 8;
+		std::size_t *buckets = histograms[digit];
+		if (buckets[(mEntries[0].key >> shift) & 0xFF] == count) {
+			continue;
+		}
+		std::size_t offset = 0;
+		for (int i = 0; i < 256; i++) {
+			std::size_t size = buckets[i];
+			buckets[i] = offset;
+			offset += size;
+		}
+		for (const Entry &entry : mEntries) {
+			mScratch[buckets[(entry.key >> shift) & 0xFF]++] = entry;
+		}
+		mEntries.swap(mScratch);
+	}
+}
+
+// A run of rectangles or sprites in one layer is handed to its batch
+// whole; when the run ends the batch is flushed, so the next run is
+// drawn over it
+void DrawList::render(SDL_Renderer *renderer) {
+	sort();
+	mRects.begin(renderer);
+	mSprites.begin(renderer);
+	Uint64 run = 0;
+	for (const Entry &entry : mEntries) {
+		const Uint64 kind = entry.key & ~(SPRITE_BIT - 1);
+		if (kind != run) {
+			mRects.flush();
+			mSprites.flush();
+			run = kind;
+		}
+		const Command &command = mCommands[entry.command];
+		if (command.texture == nullptr) {
+			mRects.fill(command.rect, command.color);
+		} else {
+			Sprite sprite = { command.texture, command.rect };
+			mSprites.draw(sprite, command.dest);
+		}
+	}
+	mRects.end();
+	mSprites.end();
+}
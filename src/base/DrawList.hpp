@@ -0,0 +1,94 @@
+#ifndef BASE_DRAW_LIST
+#define BASE_DRAW_LIST
+
+#include "base/RectBatch.hpp"
+#include "base/SpriteAtlas.hpp"
+#include "base/SpriteBatch.hpp"
+#include <SDL.h>
+#include <unordered_map>
+#include <vector>
+
+//! \brief Collects a frame's filled rectangles and sprites with a sort key
+//! each, then draws them sorted through a RectBatch and a SpriteBatch.
+//!
+//! The key orders draws by layer first, so higher layers are drawn over
+//! lower ones whatever order objects were spawned in.  A level's cached
+//! static objects, all on layer 0, are drawn before the list.  Within a layer
+//! rectangles come before sprites, sprites are grouped by texture and
+//! rectangles by colour, so the renderer's state changes as little as it
+//! can.  Draws with equal keys keep the order they were queued in.
+class DrawList {
+public:
+
+	DrawList();
+
+	void begin(); //!< Forget the draws queued for the last frame.
+
+	/**
+	 * Queue a filled rectangle
+	 * @param Uint8 layer: drawn over lower layers and under higher ones
+	 * @param const SDL_Rect& rect: the rectangle
+	 * @param SDL_Color color: its colour
+	 */
+	void fill(Uint8 layer, const SDL_Rect &rect, SDL_Color color);
+
+	/**
+	 * Queue a sprite
+	 * @param Uint8 layer: drawn over lower layers and under higher ones
+	 * @param const Sprite& sprite: the texture region to draw
+	 * @param const SDL_FRect& dest: where to draw it
+	 */
+	void draw(Uint8 layer, const Sprite &sprite, const SDL_FRect &dest);
+
+	/**
+	 * Sort the queued draws and draw them
+	 * @param SDL_Renderer* renderer: what to draw with
+	 */
+	void render(SDL_Renderer *renderer);
+
+	/**
+	 * Put the queued draws in the order render draws them.  Render sorts
+	 * them itself; this is for looking at the order without drawing.
+	 */
+	void sort();
+
+	inline std::size_t size() const { return mEntries.size(); } //!< Draws queued.
+
+	//! Which draw, counting in the order they were queued, comes i-th once sorted.
+	inline std::size_t queuedIndex(std::size_t i) const { return mEntries[i].command; }
+
+	inline int drawCalls() const { return mRects.drawCalls() + mSprites.drawCalls(); } //!< Calls made to the renderer by the last render.
+
+private:
+
+	DrawList(const DrawList&) = delete;
+	void operator=(DrawList const&) = delete;
+
+	//! A queued fill or sprite.
+	struct Command {
+		SDL_Texture *texture; // NULL for a fill
+		SDL_Rect rect; // the sprite's source, or the rectangle to fill
+		SDL_FRect dest;
+		SDL_Color color;
+	};
+
+	//! A command's sort key and where it is in mCommands.
+	struct Entry {
+		Uint64 key;
+		Uint32 command;
+	};
+
+	Uint64 textureKey(SDL_Texture *texture);
+
+	std::vector<Command> mCommands;
+	std::vector<Entry> mEntries;
+	std::vector<Entry> mScratch; // the other half of each radix pass
+	// small numbers standing in for textures in keys, kept across frames so
+	// sprites sort the same way every frame
+	std::unordered_map<SDL_Texture*, Uint64> mTextureIds;
+	RectBatch mRects;
+	SpriteBatch mSprites;
+
+};
+
+#endif
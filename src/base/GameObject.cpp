@@ -1,34 +1,86 @@
 #include "base/GameObject.hpp"
+#include "base/Level.hpp"
+#include "base/PhysicsManager.hpp"
 #include <SDL.h>
 
 GameObject::GameObject(Level & level, float x, float y, float w, float h, int tag):
   mLevel(level),
+  mStore(level.componentStore()),
+  mSlot(ComponentStore::INVALID_SLOT),
   mX(x),
   mY(y),
   mW(w),
   mH(h),
-  mTag(tag)
+  mPrevX(x),
+  mPrevY(y),
+  mTag(tag),
+  mHandle(ObjectHandle::null()),
+  mRemovalQueued(false),
+  mActive(false),
+  mStatic(false),
+  mPool(nullptr),
+  mTagSlot(0),
+  mCollisionTags(GenericComponent::NO_TAGS),
+  mSubscribedTags(GenericComponent::NO_TAGS),
+  mGridEntry()
 {
+  if (mStore) {
+    mSlot = mStore->allocate(*this, x, y, w, h);
+  }
 }
 
 GameObject::~GameObject()
 {
+  deactivate();
+  if (mStore) {
+    mStore->release(mSlot);
+  }
 }
 
 void
 GameObject::update()
 {
-  for (auto genericComponent: mGenericComponents) {
+  for (const auto & genericComponent: mGenericComponents) {
     genericComponent->update(mLevel);
   }
 }
 
 void
-GameObject::collision(std::shared_ptr<GameObject> obj)
+GameObject::collision(GameObject & obj)
+{
+  std::uint64_t tagBit = GenericComponent::tagBit(obj.tag());
+  for (const auto & genericComponent: mGenericComponents) {
+    if (genericComponent->collisionTags() & tagBit) {
+      genericComponent->collision(mLevel, obj);
+    }
+  }
+}
+
+float
+GameObject::renderX() const
+{
+  if (!mPhysicsComponent) {
+    return x();
+  }
+  float previous = mStore ? mStore->previousX(mSlot) : mPrevX;
+  return previous + (x() - previous) * mLevel.interpolation();
+}
+
+float
+GameObject::renderY() const
 {
-  for (auto genericComponent: mGenericComponents) {
-    genericComponent->collision(mLevel, obj);
+  if (!mPhysicsComponent) {
+    return y();
   }
+  float previous = mStore ? mStore->previousY(mSlot) : mPrevY;
+  return previous + (y() - previous) * mLevel.interpolation();
+}
+
+void
+GameObject::savePrevious()
+{
+  mPrevX = mX;
+  mPrevY = mY;
 }
 
 void
@@ -47,6 +99,59 @@ GameObject::render(SDL_Renderer * renderer)
   }
 }
 
+void
+GameObject::activate()
+{
+  if (mActive) {
+    return;
+  }
+  mActive = true;
+  for (const auto & genericComponent: mGenericComponents) {
+    mLevel.componentSystems().add(*genericComponent);
+  }
+  subscribeCollisions();
+  if (mStore) {
+    mStore->activate(mSlot);
+    mStore->setPhysicsComponent(mSlot, mPhysicsComponent.get());
+  }
+}
+
+void
+GameObject::deactivate()
+{
+  if (!mActive) {
+    return;
+  }
+  mActive = false;
+  for (const auto & genericComponent: mGenericComponents) {
+    mLevel.componentSystems().remove(*genericComponent);
+  }
+  PhysicsManager::getInstance().unsubscribe(mTag, mSubscribedTags);
+  mSubscribedTags = GenericComponent::NO_TAGS;
+  if (mStore) {
+    mStore->deactivate(mSlot);
+  }
+}
+
+void
+GameObject::registerGenericComponent(GenericComponent & comp)
+{
+  mLevel.componentSystems().add(comp);
+  subscribeCollisions();
+}
+
+void
+GameObject::subscribeCollisions()
+{
+  if (mSubscribedTags == mCollisionTags) {
+    return;
+  }
+  PhysicsManager & physics = PhysicsManager::getInstance();
+  physics.unsubscribe(mTag, mSubscribedTags);
+  physics.subscribe(mTag, mCollisionTags);
+  mSubscribedTags = mCollisionTags;
+}
+
 bool
 GameObject::isColliding(const GameObject & obj) const
 {
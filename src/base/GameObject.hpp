@@ -1,13 +1,25 @@
 #ifndef BASE_GAME_OBJECT
 #define BASE_GAME_OBJECT
 
+#include "base/ComponentStore.hpp"
+#include "base/ComponentSystem.hpp"
 #include "base/GenericComponent.hpp"
 #include "base/PhysicsComponent.hpp"
 #include "base/RenderComponent.hpp"
+#include "base/SlotMap.hpp"
+#include "base/SpatialGrid.hpp"
+#include <cstdint>
 #include <memory>
+#include <type_traits>
+#include <typeinfo>
 #include <vector>
 
 class Level;
+class ObjectPool;
+
+//! \brief Handle to an object in a level.  Stays valid while the object
+//! is in the level and goes stale once it is removed.
+typedef SlotHandle ObjectHandle;
 
 //! \brief Represents an object in the game.  Has some essential
 //! properties (position and size), a tag (identifying the general
@@ -16,7 +28,9 @@ class Level;
 //! and a render component.
 //!
 //! We used an object-centric architecture because we had already
-//! worked with it and it just made sense to use.
+//! worked with it and it just made sense to use.  When the level has a
+//! ComponentStore, the object is a thin handle: its transform and the
+//! links to its components live in the store's pools.
 class GameObject: public std::enable_shared_from_this<GameObject> {
 public:
 
@@ -27,51 +41,141 @@ public:
 		return mTag;
 	}
 
+	//! The level the object belongs to.
+	inline Level & level() const {
+		return mLevel;
+	}
+
+	//! Handle of the object in its level; null until the object is added.
+	inline ObjectHandle handle() const {
+		return mHandle;
+	}
+	inline void setHandle(ObjectHandle handle) {
+		mHandle = handle;
+	}
+
+	//! Position of the object in its level's list of objects with its tag.
+	inline std::size_t tagSlot() const {
+		return mTagSlot;
+	}
+	inline void setTagSlot(std::size_t slot) {
+		mTagSlot = slot;
+	}
+
+	//! Pool the object returns to when it leaves the level, if it was spawned.
+	inline ObjectPool * pool() const {
+		return mPool;
+	}
+	inline void setPool(ObjectPool *pool) {
+		mPool = pool;
+	}
+
+	//! Whether the object is queued for removal from its level.
+	inline bool isRemovalQueued() const {
+		return mRemovalQueued;
+	}
+	inline void setRemovalQueued(bool queued) {
+		mRemovalQueued = queued;
+	}
+
+	//! Whether the object never moves or changes how it looks, so its level
+	//! draws it once into a cached layer instead of every frame.  Only
+	//! objects on render layer 0 are cached, as the cached layer is drawn
+	//! under all the others.  Set before the object is added.
+	inline bool isStatic() const {
+		return mStatic;
+	}
+	inline void setStatic(bool isStatic) {
+		mStatic = isStatic;
+	}
+
 	inline void setX(float x) {
-		mX = x;
+		if (mStore) {
+			mStore->setX(mSlot, x);
+		} else {
+			mX = x;
+		}
 	}
 	inline void setY(float y) {
-		mY = y;
+		if (mStore) {
+			mStore->setY(mSlot, y);
+		} else {
+			mY = y;
+		}
 	}
 
 	inline float x() const {
-		return mX;
+		return mStore ? mStore->x(mSlot) : mX;
 	}
 	inline float y() const {
-		return mY;
+		return mStore ? mStore->y(mSlot) : mY;
 	}
+	//! Position to draw the object at: between where the last physics step
+	//! found it and where it is now, by the level's interpolation factor.
+	//! Objects without a physics body are drawn where they are.
+	float renderX() const;
+	float renderY() const;
+
 	inline float w() const {
-		return mW;
+		return mStore ? mStore->w(mSlot) : mW;
 	}
 	inline float h() const {
-		return mH;
+		return mStore ? mStore->h(mSlot) : mH;
 	}
 
-	inline void addGenericComponent(std::shared_ptr<GenericComponent> comp) {
+	//! Add a generic component.  The component's static type decides which
+	//! batch updates it, so pass it as its concrete type where possible;
+	//! components added as a plain GenericComponent, or as any type other
+	//! than their own, are updated virtually, in the default phase and
+	//! never concurrently, as their batch could not call their override.
+	template<typename T>
+	inline void addGenericComponent(const std::shared_ptr<T> &comp) {
+		static_assert(std::is_base_of<GenericComponent, T>::value,
+				"generic components must derive from GenericComponent");
+		GenericComponent &generic = *comp;
+		if (generic.mType == nullptr) {
+			generic.mType = typeid(generic) == typeid(T)
+					? &ComponentType::of<T>()
+					: &ComponentType::of<GenericComponent>();
+		}
 		mGenericComponents.push_back(comp);
+		mCollisionTags |= generic.collisionTags();
+		if (mActive) {
+			registerGenericComponent(generic);
+		}
 	}
 	inline void setPhysicsComponent(std::shared_ptr<PhysicsComponent> comp) {
 		mPhysicsComponent = comp;
+		if (mStore) {
+			mStore->setPhysicsComponent(mSlot, comp.get());
+		}
 	}
 	inline void setRenderComponent(std::shared_ptr<RenderComponent> comp) {
 		mRenderComponent = comp;
 	}
 
-	inline std::vector<std::shared_ptr<GenericComponent>> genericComponents() {
+	// The accessors hand out references, so callers borrow the components
+	// rather than copying a shared_ptr (and its atomic refcount) each call.
+	inline const std::vector<std::shared_ptr<GenericComponent>> & genericComponents() const {
 		return mGenericComponents;
 	}
-	inline std::shared_ptr<PhysicsComponent> physicsComponent() {
+	inline const std::shared_ptr<PhysicsComponent> & physicsComponent() const {
 		return mPhysicsComponent;
 	}
-	inline std::shared_ptr<RenderComponent> renderComponent() {
+	inline const std::shared_ptr<RenderComponent> & renderComponent() const {
 		return mRenderComponent;
 	}
 
-	void update(); //!< Update the object.
-	void collision(std::shared_ptr<GameObject> obj); //!< Handle collisions with another object.
+	void update(); //!< Update the object on its own; levels update components in type batches instead.
+	void collision(GameObject &obj); //!< Pass a collision to the components that want obj's tag.
+	void savePrevious(); //!< Before the physics step for the object; remembers where it was.
 	void postStep(); //!< After the physics step for the object.
 	void render(SDL_Renderer *renderer); //!< Render the object.
 
+	void activate(); //!< Called when the object enters the level; registers and pools its components.
+	void deactivate(); //!< Called when the object leaves the level.
+	inline bool isActive() const { return mActive; }
+
 	bool isColliding(const GameObject &obj) const; //!< Determine if this object is colliding with another.
 	bool isColliding(float px, float py) const; //!< Determine if this object is colliding with a point.
 
@@ -80,11 +184,30 @@ private:
 	GameObject(const GameObject&) = delete;
 	void operator=(GameObject const&) = delete;
 
+	friend class SpatialGrid;
+
+	void registerGenericComponent(GenericComponent &comp);
+	void subscribeCollisions(); //!< Bring the physics manager's table in line with mCollisionTags.
+
 	Level &mLevel;
 
+	ComponentStore *mStore;
+	ComponentStore::Slot mSlot;
+
 	float mX, mY, mW, mH;
+	float mPrevX, mPrevY;
 	int mTag;
 
+	ObjectHandle mHandle;
+	bool mRemovalQueued;
+	bool mActive;
+	bool mStatic;
+	ObjectPool *mPool;
+	std::size_t mTagSlot;
+	std::uint64_t mCollisionTags; // tags any of the components wants collisions with
+	std::uint64_t mSubscribedTags; // what the physics manager has been told
+	SpatialGrid::Entry mGridEntry;
+
 	std::vector<std::shared_ptr<GenericComponent>> mGenericComponents;
 	std::shared_ptr<PhysicsComponent> mPhysicsComponent;
 	std::shared_ptr<RenderComponent> mRenderComponent;
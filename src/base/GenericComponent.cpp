@@ -1,7 +1,11 @@
 #include "base/GenericComponent.hpp"
+#include "base/ComponentSystem.hpp"
 
 GenericComponent::GenericComponent(GameObject & gameObject):
-  Component(gameObject)
+  Component(gameObject),
+  mType(nullptr),
+  mSystemIndex(ComponentSystem::NOT_REGISTERED),
+  mCollisionTags(ALL_TAGS)
 {
 }
 
@@ -11,6 +15,6 @@ GenericComponent::update(Level & level)
 }
 
 void
-GenericComponent::collision(Level & level, std::shared_ptr<GameObject> obj)
+GenericComponent::collision(Level & level, GameObject & obj)
 {
 }
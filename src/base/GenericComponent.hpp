@@ -2,18 +2,71 @@
 #define BASE_GENERIC_COMPONENT
 
 #include "base/Component.hpp"
+#include <cstddef>
+#include <cstdint>
 #include <memory>
 
 class Level;
+struct ComponentType;
 
 //! \brief A generic component that can handle updating and collisions.
 class GenericComponent: public Component {
 public:
   
+  //! Update phases.  Each component type updates in one batch, and the
+  //! batches run in phase order; a type picks its phase by declaring its
+  //! own PHASE.
+  enum UpdatePhase { PHASE_INPUT, PHASE_DEFAULT, PHASE_LATE };
+  static const int PHASE = PHASE_DEFAULT;
+
+  //! What an update touches.  A type declares its own READS and WRITES;
+  //! if it only writes its owner and never reads other objects, its batch
+  //! may be split across the job system's threads.  Adding and removing
+  //! objects through the level needs no declaration, since calls from a
+  //! worker are buffered and applied in order afterwards.
+  enum Access {
+    ACCESS_OWNER = 1 << 0, //!< The owning object, its body and its components.
+    ACCESS_OBJECTS = 1 << 1, //!< Other objects.
+    ACCESS_WORLD = 1 << 2, //!< Creating objects or bodies, physics queries.
+    ACCESS_LEVEL = 1 << 3, //!< Level state such as score and power-ups.
+    ACCESS_INPUT = 1 << 4, //!< The input manager.
+    ACCESS_AUDIO = 1 << 5, //!< Playing sounds.
+    ACCESS_ALL = 0xFF
+  };
+  static const unsigned READS = ACCESS_ALL;
+  static const unsigned WRITES = ACCESS_ALL;
+
   GenericComponent(GameObject & gameObject);
 
   virtual void update(Level & level); //!< Update the object.
-  virtual void collision(Level & level, std::shared_ptr<GameObject> obj); //!< Handle a collision with the given object.
+  virtual void collision(Level & level, GameObject & obj); //!< Handle a collision with the given object.
+
+  static const std::uint64_t ALL_TAGS = ~std::uint64_t(0);
+  static const std::uint64_t NO_TAGS = 0;
+
+  //! The collision bit of a tag; tags from 63 up share the last bit.
+  static inline std::uint64_t tagBit(int tag) {
+    return std::uint64_t(1) << ((tag >= 0 && tag < 63) ? tag : 63);
+  }
+
+  //! Tags of the objects this component hears collisions with; all by default.
+  inline std::uint64_t collisionTags() const { return mCollisionTags; }
+
+protected:
+
+  //! Only report collisions with objects whose tag bit is in tags.  Call it
+  //! from the constructor, before the component is added to its object.
+  inline void setCollisionTags(std::uint64_t tags) { mCollisionTags = tags; }
+
+private:
+
+  friend class ComponentSystem;
+  friend class ComponentRegistry;
+  friend class GameObject;
+
+  const ComponentType * mType; //!< Concrete type, set when added to an object.
+  std::size_t mSystemIndex; //!< Position in its type's system, if registered.
+  std::uint64_t mCollisionTags;
 
 };
 
@@ -0,0 +1,256 @@
+#include "base/HeadlessProgram.hpp"
+#include "base/InputManager.hpp"
+#include "base/JobSystem.hpp"
+#include "base/OwnershipStats.hpp"
+#include "base/PhysicsManager.hpp"
+#include "base/Profiler.hpp"
+#include "base/SimulationClock.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+// Only the subsystems the simulation needs; no video, so no display
+HeadlessProgram::HeadlessProgram(std::vector<std::shared_ptr<Level>> levels,
+		const RunOptions &options) :
+		mLevels(levels), mLevelNum(0), mOptions(options), mNextKey(0), mTick(
+				0), mWins(0), mDeaths(0), mLevelTicks(0), mSteadyTicks(0), mAllocatingTicks(0), mFirstAllocatingTick(
+				-1), mFirstAllocations(), mCopyingTicks(0), mFirstCopyingTick(
+				-1) {
+	if (SDL_Init(SDL_INIT_TIMER | SDL_INIT_EVENTS) < 0) {
+		std::cout << "SDL could not initialize! SDL Error: " << SDL_GetError()
+				<< "\n";
+	}
+	InputManager::getInstance().startUp();
+	PhysicsManager::getInstance().startUp();
+	SimulationClock::getInstance().startUp();
+	Profiler::getInstance().startUp();
+	JobSystem::getInstance().startUp();
+
+	std::uint32_t seed = static_cast<std::uint32_t>(time(nullptr));
+	if (!mOptions.replay.empty() && mRecording.startReplay(mOptions.replay)) {
+		seed = mRecording.seed();
+		PhysicsManager::getInstance().setTimeStep(mRecording.timeStep());
+	} else {
+		if (!mOptions.record.empty()) {
+			mRecording.startRecording(mOptions.record, seed,
+					PhysicsManager::getInstance().timeStep());
+		}
+		if (!mOptions.script.empty()) {
+			loadScript(mOptions.script);
+		}
+	}
+	srand(seed);
+}
+
+HeadlessProgram::~HeadlessProgram() {
+	mRecording.finish();
+	JobSystem::getInstance().shutDown();
+	Profiler::getInstance().shutDown();
+	SimulationClock::getInstance().shutDown();
+	PhysicsManager::getInstance().shutDown();
+	InputManager::getInstance().shutDown();
+	SDL_Quit();
+}
+
+bool HeadlessProgram::loadScript(const std::string &filename) {
+	std::ifstream inFile(filename);
+	if (!inFile.is_open()) {
+		SDL_Log("Failed to open input script");
+		return false;
+	}
+	std::string line;
+	int lineNum = 0;
+	while (getline(inFile, line)) {
+		lineNum++;
+		if (line.empty() || line[0] == '#') {
+			continue;
+		}
+		std::istringstream fields(line);
+		long tick;
+		std::string action;
+		std::string keyName;
+		fields >> tick >> action;
+		// the rest of the line, as key names such as "Left Shift" have spaces
+		getline(fields >> std::ws, keyName);
+		SDL_Keycode key = SDL_GetKeyFromName(keyName.c_str());
+		if (fields.fail() || key == SDLK_UNKNOWN
+				|| (action != "down" && action != "up" && action != "press")) {
+			SDL_Log("Skipping input script line %d", lineNum);
+			continue;
+		}
+		if (action == "down" || action == "press") {
+			scheduleKey(tick, key, true);
+		}
+		if (action == "up" || action == "press") {
+			scheduleKey(action == "press" ? tick + 1 : tick, key, false);
+		}
+	}
+	return true;
+}
+
+void HeadlessProgram::scheduleKey(long tick, SDL_Keycode key, bool down) {
+	ScriptedKey scripted = { tick, key, down };
+	mScript.push_back(scripted);
+}
+
+bool HeadlessProgram::run() {
+	// stable, so keys on the same tick keep the order they were given in
+	std::stable_sort(mScript.begin(), mScript.end(),
+			[](const ScriptedKey &a, const ScriptedKey &b) {
+				return a.tick < b.tick;
+			});
+	mNextKey = 0;
+	// a replay starts on whichever level its recording did
+	int levelNum = 0;
+	mRecording.levelToStart(levelNum);
+	startLevel(levelNum);
+	ALLOC_END_FRAME(); // setting up is not part of the first tick
+	OwnershipStats::endFrame();
+
+	const bool replaying = mRecording.isReplaying();
+	const double timeStep = PhysicsManager::getInstance().timeStep();
+	const double counterFrequency = SDL_GetPerformanceFrequency();
+	const Uint64 start = SDL_GetPerformanceCounter();
+	for (mTick = 0; replaying ? !mRecording.isFinished() : mTick < mOptions.ticks;
+			mTick++) {
+		mLevelTicks++;
+		while (mRecording.levelToStart(levelNum)) {
+			if (mLevel->isWin()) {
+				mWins++;
+			} else if (mLevel->getDie()) {
+				mDeaths++;
+			}
+			if (static_cast<std::size_t>(levelNum) < mLevels.size()) {
+				startLevel(levelNum);
+			}
+		}
+		deliverInput();
+		mRecording.beginStep();
+		{
+			PROFILE_SCOPE(UPDATE);
+			mLevel->update();
+		}
+		InputManager::getInstance().resetForFrame();
+		// the allocation check covers recording the frame the windowed game
+		// would draw, into each of the level's two frames in turn; there is
+		// no renderer, so nothing is drawn
+		if (mOptions.checkAllocs >= 0) {
+			mLevel->record();
+			mLevel->swapFrames();
+		}
+		// a replay changes level only where the recording did
+		if (!replaying) {
+			checkLevel();
+		}
+
+		if (mOptions.speed > 0) {
+			double due = (mTick + 1) * timeStep / mOptions.speed;
+			double elapsed = (SDL_GetPerformanceCounter() - start)
+					/ counterFrequency;
+			if (elapsed < due) {
+				SDL_Delay(Uint32((due - elapsed) * 1000));
+			}
+		}
+		PROFILE_END_FRAME();
+		ALLOC_END_FRAME();
+		OwnershipStats::endFrame();
+		// a level that started this tick has not reached a steady state
+		if (mOptions.checkAllocs >= 0 && mLevelTicks > mOptions.checkAllocs) {
+			mSteadyTicks++;
+			if (AllocationTracker::lastFrame().totalAllocations() > 0
+					&& mAllocatingTicks++ == 0) {
+				mFirstAllocatingTick = mTick;
+				mFirstAllocations = AllocationTracker::lastFrame();
+			}
+			if (OwnershipStats::lastFrame() > 0 && mCopyingTicks++ == 0) {
+				mFirstCopyingTick = mTick;
+			}
+		}
+	}
+	double seconds = (SDL_GetPerformanceCounter() - start) / counterFrequency;
+	mLevel->finalize();
+	mRecording.finish();
+
+	std::cout << "Headless run: " << mTick << " ticks in " << seconds << " s ("
+			<< (seconds > 0 ? mTick / seconds : 0) << " ticks/s), " << mWins
+			<< " levels won, " << mDeaths << " deaths" << std::endl;
+#ifdef ENGINE_PROFILER
+	// each tick is a frame here, and only the last few are kept
+	for (const std::string &line : Profiler::getInstance().summary()) {
+		std::cout << line << "\n";
+	}
+#endif
+
+	if (mOptions.checkAllocs < 0) {
+		return true;
+	}
+	if (!AllocationTracker::enabled()) {
+		std::cout << "Allocation check needs a build with ENGINE_ALLOC_TRACKING"
+				<< std::endl;
+		return false;
+	}
+	// a run whose levels all end before the warm-up would pass unchecked
+	if (mSteadyTicks == 0) {
+		std::cout << "Allocation check failed: no level ran past tick "
+				<< mOptions.checkAllocs << std::endl;
+		return false;
+	}
+	if (mCopyingTicks > 0) {
+		std::cout << "Allocation check failed: " << mCopyingTicks
+				<< " steady ticks copied shared_ptrs, the first at tick "
+				<< mFirstCopyingTick << std::endl;
+	}
+	if (mAllocatingTicks > 0) {
+		std::cout << "Allocation check failed: " << mAllocatingTicks
+				<< " steady ticks allocated, the first at tick "
+				<< mFirstAllocatingTick << " with "
+				<< mFirstAllocations.describe() << std::endl;
+	}
+	if (mAllocatingTicks > 0 || mCopyingTicks > 0) {
+		return false;
+	}
+	std::cout << "Allocation check passed over " << mSteadyTicks
+			<< " steady ticks" << std::endl;
+	return true;
+}
+
+void HeadlessProgram::deliverInput() {
+	while (mNextKey < mScript.size() && mScript[mNextKey].tick <= mTick) {
+		const ScriptedKey &scripted = mScript[mNextKey++];
+		SDL_Event e;
+		std::memset(&e, 0, sizeof(e));
+		e.type = scripted.down ? SDL_KEYDOWN : SDL_KEYUP;
+		e.key.keysym.sym = scripted.key;
+		InputManager::getInstance().handleEvent(e);
+	}
+}
+
+// Same rules as the windowed game, with a restart standing in for R
+void HeadlessProgram::checkLevel() {
+	if (mLevel->getEditingMode()) {
+		return;
+	}
+	if (mLevel->isWin()) {
+		mWins++;
+		startLevel((mLevelNum + 1) % mLevels.size());
+	} else if (mLevel->getDie()) {
+		mDeaths++;
+		startLevel(mLevelNum);
+	}
+}
+
+void HeadlessProgram::startLevel(std::size_t levelNum) {
+	if (mLevel) {
+		mLevel->finalize();
+	}
+	mLevelNum = levelNum;
+	mLevel = mLevels[mLevelNum];
+	mLevel->initialize(nullptr);
+	mLevelTicks = 0;
+	mRecording.levelStarted(static_cast<int>(mLevelNum));
+}
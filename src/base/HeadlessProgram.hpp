@@ -0,0 +1,109 @@
+#ifndef BASE_HEADLESS_PROGRAM
+#define BASE_HEADLESS_PROGRAM
+
+#include "base/AllocationTracker.hpp"
+#include "base/InputRecording.hpp"
+#include "base/Level.hpp"
+#include "base/RunOptions.hpp"
+#include <SDL.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+//! \brief Runs a game's levels without a window, renderer or audio, for
+//! soak tests, balancing and performance runs on machines with no display.
+//!
+//! Levels are initialized with a null renderer and updated at the fixed
+//! tick rate, either flat out or paced to a multiple of real time.  Input
+//! comes from a script rather than the keyboard: each line is a tick, an
+//! action (down, up or press) and an SDL key name, e.g. "120 down Left";
+//! lines starting with # are ignored.  A death restarts the level and a
+//! win moves on to the next one, so a run can go on for as long as asked.
+//!
+//! Given a recording to replay, the run instead takes its seed, time step,
+//! key state and level changes from the recording and lasts as long as it.
+//!
+//! With --check-allocs N in a build with allocation tracking, each tick
+//! also records a frame as the windowed game would, and every tick from
+//! the Nth of a level on must make no heap allocations and no
+//! shared_ptr copies of the level's objects (see OwnershipStats), and the
+//! run fails if one does, or if no level lasts N ticks.
+class HeadlessProgram {
+public:
+
+	/**
+	 * Constructor
+	 * @param std::vector<std::shared_ptr<Level>> levels: the game's levels, in order
+	 * @param const RunOptions& options: ticks, speed, script and recordings
+	 */
+	HeadlessProgram(std::vector<std::shared_ptr<Level>> levels,
+			const RunOptions &options);
+
+	~HeadlessProgram();
+
+	/**
+	 * Queue key events from a script file.  Returns false if it could not
+	 * be read; malformed lines are logged and skipped.
+	 * @param const std::string& filename: path of the script
+	 */
+	bool loadScript(const std::string &filename);
+
+	/**
+	 * Queue a key going down or up at the start of a tick
+	 * @param long tick: the tick to deliver it on
+	 * @param SDL_Keycode key: the key
+	 * @param bool down: whether the key goes down or up
+	 */
+	void scheduleKey(long tick, SDL_Keycode key, bool down);
+
+	/**
+	 * Run the configured number of ticks, or the replay, and print a
+	 * summary.  Returns false if the allocation check failed.
+	 */
+	bool run();
+
+	inline long ticksRun() const { return mTick; } //!< Ticks run so far.
+	inline int wins() const { return mWins; } //!< Levels won so far.
+	inline int deaths() const { return mDeaths; } //!< Levels lost so far.
+
+private:
+
+	HeadlessProgram(const HeadlessProgram&) = delete;
+	void operator=(HeadlessProgram const&) = delete;
+
+	struct ScriptedKey {
+		long tick;
+		SDL_Keycode key;
+		bool down;
+	};
+
+	void deliverInput(); //!< Feed this tick's scripted keys to the input manager.
+	void checkLevel(); //!< Move on after a win, restart after a death.
+	void startLevel(std::size_t levelNum);
+
+	std::vector<std::shared_ptr<Level>> mLevels;
+	std::shared_ptr<Level> mLevel;
+	std::size_t mLevelNum;
+	RunOptions mOptions;
+	InputRecording mRecording;
+	std::vector<ScriptedKey> mScript; // sorted by tick once the run starts
+	std::size_t mNextKey;
+	long mTick;
+	int mWins;
+	int mDeaths;
+	long mLevelTicks; // ticks since the level started
+	long mSteadyTicks; // ticks checked for allocations
+
+	// steady ticks that allocated, and the first of them, kept as counts
+	// since describing it would allocate during the run
+	long mAllocatingTicks;
+	long mFirstAllocatingTick;
+	AllocationTracker::Counts mFirstAllocations;
+
+	// steady ticks that copied shared_ptrs, and the first of them
+	long mCopyingTicks;
+	long mFirstCopyingTick;
+
+};
+
+#endif
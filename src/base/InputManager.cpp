@@ -3,6 +3,19 @@
 #include <math.h>
 #include <iostream>
 
+namespace {
+
+// Add a key to a sorted list unless it is there already
+void insertKey(std::vector<SDL_Keycode> & keys, SDL_Keycode key)
+{
+  auto it = std::lower_bound(keys.begin(), keys.end(), key);
+  if (it == keys.end() || *it != key) {
+    keys.insert(it, key);
+  }
+}
+
+}
+
 InputManager &
 InputManager::getInstance()
 {
@@ -26,17 +39,33 @@ InputManager::resetForFrame()
   mKeysPressed.clear();
 }
 
+void
+InputManager::getSnapshot(Snapshot & snapshot) const
+{
+  snapshot.down.assign(mKeysDown.begin(), mKeysDown.end());
+  snapshot.pressed.assign(mKeysPressed.begin(), mKeysPressed.end());
+}
+
+void
+InputManager::setSnapshot(const Snapshot & snapshot)
+{
+  mKeysDown.assign(snapshot.down.begin(), snapshot.down.end());
+  mKeysPressed.assign(snapshot.pressed.begin(), snapshot.pressed.end());
+}
+
 void
 InputManager::handleEvent(const SDL_Event & e)
 {
   if (e.type == SDL_KEYDOWN) {
-    auto elem = mKeysDown.find(e.key.keysym.sym);
-    if (elem == mKeysDown.end()) {
-      mKeysPressed.insert(e.key.keysym.sym);
+    if (!isKeyDown(e.key.keysym.sym)) {
+      insertKey(mKeysPressed, e.key.keysym.sym);
     }
-    mKeysDown.insert(e.key.keysym.sym);
+    insertKey(mKeysDown, e.key.keysym.sym);
   } else if (e.type == SDL_KEYUP) {
-    mKeysDown.erase(e.key.keysym.sym);
+    auto it = std::lower_bound(mKeysDown.begin(), mKeysDown.end(), e.key.keysym.sym);
+    if (it != mKeysDown.end() && *it == e.key.keysym.sym) {
+      mKeysDown.erase(it);
+    }
   }
 }
 
@@ -49,13 +78,13 @@ InputManager::getMouseGridPosition(float size) {
 bool
 InputManager::isKeyDown(SDL_Keycode k) const
 {
-  return mKeysDown.find(k) != mKeysDown.end();
+  return std::binary_search(mKeysDown.begin(), mKeysDown.end(), k);
 }
 
 bool
 InputManager::isKeyPressed(SDL_Keycode k) const
 {
-  return mKeysPressed.find(k) != mKeysPressed.end();
+  return std::binary_search(mKeysPressed.begin(), mKeysPressed.end(), k);
 }
 
 bool 
@@ -1,5 +1,8 @@
+#ifndef BASE_INPUT_MANAGER
+#define BASE_INPUT_MANAGER
+
 #include <SDL.h>
-#include <set>
+#include <vector>
 
 //! \brief Class for managing (keyboard) input.
 class InputManager {
@@ -16,10 +19,19 @@ public:
   void startUp();
   void shutDown();
 
-  void resetForFrame(); //!< Reset key state for a new frame.
+  //! The keyboard as a simulation step sees it.
+  struct Snapshot {
+    std::vector<SDL_Keycode> down; //!< Keys held, in key order.
+    std::vector<SDL_Keycode> pressed; //!< Keys pressed since the last step, in key order.
+  };
+
+  void getSnapshot(Snapshot & snapshot) const; //!< Copy out the key state.
+  void setSnapshot(const Snapshot & snapshot); //!< Replace the key state, as a replay does.
+
+  void resetForFrame(); //!< Forget key presses once a simulation step has seen them.
   void handleEvent(const SDL_Event & e); //!< Update key state based on an event.
   bool isKeyDown(SDL_Keycode k) const; //!< Get if a key is currently down.
-  bool isKeyPressed(SDL_Keycode k) const; //!< Get if a key was pressed this frame.
+  bool isKeyPressed(SDL_Keycode k) const; //!< Get if a key was pressed since the last simulation step.
   bool isHovering(float x, float y, const float size);
   bool isMouseDown();
   std::pair<int, int> getMouseGridPosition(float size);
@@ -28,9 +40,13 @@ public:
   
 private:
 
-  std::set<SDL_Keycode> mKeysDown;
-  std::set<SDL_Keycode> mKeysPressed;
+  // sorted; a handful of keys, and unlike a set they stop allocating once
+  // they have grown to the most keys held at once
+  std::vector<SDL_Keycode> mKeysDown;
+  std::vector<SDL_Keycode> mKeysPressed;
   bool mMouseDown = false;
   int mMouseCoordinateX;
   int mMouseCoordinateY;
 };
+
+#endif
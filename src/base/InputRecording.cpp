@@ -0,0 +1,239 @@
+#include "base/InputRecording.hpp"
+#include <climits>
+#include <cstring>
+#include <iterator>
+#include <utility>
+
+namespace {
+
+const char MAGIC[4] = { 'R', 'P', 'L', 'Y' };
+const unsigned char VERSION = 1;
+
+}
+
+InputRecording::InputRecording() :
+		mMode(OFF), mSeed(0), mTimeStep(0.0f), mStep(0), mLength(0), mLastRecordStep(
+				0), mCursor(0), mNextStep(0), mNextKind(END) {
+}
+
+InputRecording::~InputRecording() {
+	finish();
+}
+
+bool InputRecording::startRecording(const std::string &filename,
+		std::uint32_t seed, float timeStep) {
+	finish();
+	mOut.open(filename, std::ios::binary | std::ios::trunc);
+	if (!mOut.is_open()) {
+		SDL_Log("Failed to create input recording");
+		return false;
+	}
+	mMode = RECORDING;
+	mSeed = seed;
+	mTimeStep = timeStep;
+	mStep = 0;
+	mLastRecordStep = 0;
+	mKeys.down.clear();
+	mKeys.pressed.clear();
+
+	std::uint32_t timeStepBits;
+	std::memcpy(&timeStepBits, &timeStep, sizeof(timeStepBits));
+	mOut.write(MAGIC, sizeof(MAGIC));
+	mOut.put(VERSION);
+	writeWord(seed);
+	writeWord(timeStepBits);
+	return true;
+}
+
+bool InputRecording::startReplay(const std::string &filename) {
+	finish();
+	std::ifstream inFile(filename, std::ios::binary);
+	if (!inFile.is_open()) {
+		SDL_Log("Failed to open input recording");
+		return false;
+	}
+	mData.assign(std::istreambuf_iterator<char>(inFile),
+			std::istreambuf_iterator<char>());
+	if (mData.size() < sizeof(MAGIC) + 1
+			|| std::memcmp(&mData[0], MAGIC, sizeof(MAGIC)) != 0
+			|| mData[sizeof(MAGIC)] != VERSION) {
+		SDL_Log("Not an input recording");
+		mData.clear();
+		return false;
+	}
+	mCursor = sizeof(MAGIC) + 1;
+	std::uint32_t timeStepBits;
+	if (!readWord(mSeed) || !readWord(timeStepBits)) {
+		SDL_Log("Not an input recording");
+		mData.clear();
+		return false;
+	}
+	std::memcpy(&mTimeStep, &timeStepBits, sizeof(mTimeStep));
+	mMode = REPLAYING;
+	mStep = 0;
+	mLength = LONG_MAX;
+	mNextStep = 0;
+	mKeys.down.clear();
+	mKeys.pressed.clear();
+	readRecordHeader();
+	return true;
+}
+
+void InputRecording::levelStarted(int levelNum) {
+	if (mMode != RECORDING) {
+		return;
+	}
+	writeRecord(LEVEL);
+	writeVarint(static_cast<std::uint32_t>(levelNum));
+}
+
+bool InputRecording::levelToStart(int &levelNum) {
+	if (mMode != REPLAYING || mNextKind != LEVEL || mNextStep != mStep) {
+		return false;
+	}
+	std::uint32_t value;
+	if (!readVarint(value)) {
+		corrupt();
+		return false;
+	}
+	levelNum = static_cast<int>(value);
+	readRecordHeader();
+	return true;
+}
+
+// Key state is compared rather than written every step, so a held key
+// costs nothing until it is let go
+void InputRecording::beginStep() {
+	if (mMode == RECORDING) {
+		InputManager::getInstance().getSnapshot(mScratch);
+		if (mScratch.down != mKeys.down || mScratch.pressed != mKeys.pressed) {
+			writeRecord(KEYS);
+			writeKeys(mScratch.down);
+			writeKeys(mScratch.pressed);
+			std::swap(mKeys, mScratch);
+		}
+	} else if (mMode == REPLAYING) {
+		while (mNextStep == mStep && mNextKind != END) {
+			if (mNextKind == KEYS) {
+				if (!readKeys(mKeys.down) || !readKeys(mKeys.pressed)) {
+					corrupt();
+					break;
+				}
+			} else {
+				// a level the caller did not ask for; keep the stream in step
+				std::uint32_t ignored;
+				if (!readVarint(ignored)) {
+					corrupt();
+					break;
+				}
+			}
+			readRecordHeader();
+		}
+		InputManager::getInstance().setSnapshot(mKeys);
+	} else {
+		return;
+	}
+	mStep++;
+}
+
+void InputRecording::finish() {
+	if (mMode == RECORDING) {
+		writeRecord(END);
+		mOut.close();
+	}
+	mData.clear();
+	mMode = OFF;
+}
+
+void InputRecording::writeRecord(RecordKind kind) {
+	writeVarint(static_cast<std::uint32_t>(mStep - mLastRecordStep));
+	mOut.put(static_cast<char>(kind));
+	mLastRecordStep = mStep;
+}
+
+// Seven bits a byte, low bits first; the top bit says more follow
+void InputRecording::writeVarint(std::uint32_t value) {
+	while (value >= 0x80) {
+		mOut.put(static_cast<char>((value & 0x7F) | 0x80));
+		value >>= 7;
+	}
+	mOut.put(static_cast<char>(value));
+}
+
+void InputRecording::writeWord(std::uint32_t value) {
+	for (int i = 0; i < 4; i++) {
+		mOut.put(static_cast<char>((value >> (8 * i)) & 0xFF));
+	}
+}
+
+void InputRecording::writeKeys(const std::vector<SDL_Keycode> &keys) {
+	writeVarint(static_cast<std::uint32_t>(keys.size()));
+	for (SDL_Keycode key : keys) {
+		writeVarint(static_cast<std::uint32_t>(key));
+	}
+}
+
+bool InputRecording::readRecordHeader() {
+	std::uint32_t steps;
+	if (!readVarint(steps) || mCursor >= mData.size()) {
+		corrupt();
+		return false;
+	}
+	mNextStep += steps;
+	mNextKind = mData[mCursor++];
+	if (mNextKind == END) {
+		mLength = mNextStep;
+	} else if (mNextKind != KEYS && mNextKind != LEVEL) {
+		corrupt();
+		return false;
+	}
+	return true;
+}
+
+bool InputRecording::readVarint(std::uint32_t &value) {
+	value = 0;
+	for (int shift = 0; shift < 35; shift += 7) {
+		if (mCursor >= mData.size()) {
+			return false;
+		}
+		unsigned char byte = mData[mCursor++];
+		value |= static_cast<std::uint32_t>(byte & 0x7F) << shift;
+		if ((byte & 0x80) == 0) {
+			return true;
+		}
+	}
+	return false;
+}
+
+bool InputRecording::readWord(std::uint32_t &value) {
+	if (mData.size() - mCursor < 4) {
+		return false;
+	}
+	value = 0;
+	for (int i = 0; i < 4; i++) {
+		value |= static_cast<std::uint32_t>(mData[mCursor++]) << (8 * i);
+	}
+	return true;
+}
+
+bool InputRecording::readKeys(std::vector<SDL_Keycode> &keys) {
+	std::uint32_t count;
+	if (!readVarint(count)) {
+		return false;
+	}
+	keys.clear();
+	for (std::uint32_t i = 0; i < count; i++) {
+		std::uint32_t key;
+		if (!readVarint(key)) {
+			return false;
+		}
+		keys.push_back(static_cast<SDL_Keycode>(key));
+	}
+	return true;
+}
+
+void InputRecording::corrupt() {
+	SDL_Log("Input recording ends early at step %ld", mStep);
+	mNextKind = END;
+	mLength = mStep;
+}
@@ -0,0 +1,123 @@
+#ifndef BASE_INPUT_RECORDING
+#define BASE_INPUT_RECORDING
+
+#include "base/InputManager.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+//! \brief Records the input a run's simulation steps saw, and plays it
+//! back.
+//!
+//! A recording holds the random seed, the time step, the key state of each
+//! step and the steps at which levels were started, so replaying it on
+//! the simulation clock repeats the run step for step.  Key state is only
+//! written on the steps where it changes.
+//!
+//! The file is a 4-byte magic and a version byte, the seed and the time
+//! step's bits as little-endian 32-bit words, then records.  Each record
+//! is a varint count of steps since the previous record and a kind byte:
+//! key state (a varint count and varint keycodes for the keys down, then
+//! the same for the keys pressed), level (a varint level number), or end,
+//! whose step count makes up the length of the recording.
+class InputRecording {
+public:
+
+	InputRecording();
+	~InputRecording();
+
+	/**
+	 * Start writing a recording; does nothing and returns false if the
+	 * file cannot be created
+	 * @param const std::string& filename: where to write it
+	 * @param std::uint32_t seed: the seed the run gave srand
+	 * @param float timeStep: seconds per simulation step
+	 */
+	bool startRecording(const std::string &filename, std::uint32_t seed,
+			float timeStep);
+
+	/**
+	 * Load a recording to play back; returns false if it cannot be read
+	 * or is not a recording
+	 * @param const std::string& filename: the recording
+	 */
+	bool startReplay(const std::string &filename);
+
+	inline bool isRecording() const { return mMode == RECORDING; }
+	inline bool isReplaying() const { return mMode == REPLAYING; }
+
+	inline std::uint32_t seed() const { return mSeed; } //!< The recorded run's seed.
+	inline float timeStep() const { return mTimeStep; } //!< The recorded run's seconds per step.
+	inline long step() const { return mStep; } //!< Steps recorded or replayed so far.
+
+	/**
+	 * While recording, note that a level was started before the next step
+	 * @param int levelNum: index of the level in the game's list
+	 */
+	void levelStarted(int levelNum);
+
+	/**
+	 * While replaying, take the next level the recording started before
+	 * the coming step; false once there are no more for this step
+	 * @param int& levelNum: set to the index of the level
+	 */
+	bool levelToStart(int &levelNum);
+
+	/**
+	 * Call before each simulation step.  Recording, this notes the key
+	 * state the step will see; replaying, it gives the input manager the
+	 * key state the recorded step saw.
+	 */
+	void beginStep();
+
+	inline bool isFinished() const { return mMode == REPLAYING && mStep >= mLength; } //!< Whether a replay has run out.
+
+	void finish(); //!< Stop; a recording is completed and closed.
+
+private:
+
+	InputRecording(const InputRecording&) = delete;
+	void operator=(InputRecording const&) = delete;
+
+	enum Mode {
+		OFF, RECORDING, REPLAYING
+	};
+
+	enum RecordKind {
+		KEYS = 0, LEVEL = 1, END = 2
+	};
+
+	void writeRecord(RecordKind kind);
+	void writeVarint(std::uint32_t value);
+	void writeWord(std::uint32_t value);
+	void writeKeys(const std::vector<SDL_Keycode> &keys);
+
+	bool readRecordHeader(); // the next record's step and kind, or false at the end
+	bool readVarint(std::uint32_t &value);
+	bool readWord(std::uint32_t &value);
+	bool readKeys(std::vector<SDL_Keycode> &keys);
+	void corrupt(); // stop a replay whose file ends or goes wrong early
+
+	Mode mMode;
+	std::uint32_t mSeed;
+	float mTimeStep;
+	long mStep; // the step about to run
+	long mLength; // steps in the replay
+
+	// recording
+	std::ofstream mOut;
+	long mLastRecordStep;
+	InputManager::Snapshot mKeys; // last written, or last read when replaying; empty at first
+	InputManager::Snapshot mScratch;
+
+	// replaying
+	std::vector<unsigned char> mData;
+	std::size_t mCursor;
+	long mNextStep; // step of the record mNextKind names
+	int mNextKind;
+
+};
+
+#endif
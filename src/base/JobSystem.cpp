@@ -0,0 +1,149 @@
+#include "base/JobSystem.hpp"
+#include "base/AllocationTracker.hpp"
+#include <algorithm>
+#include <cstdlib>
+
+namespace {
+
+// index of the pool thread running this code, or -1 outside of a job
+thread_local int tThreadIndex = -1;
+
+}
+
+JobSystem::JobSystem() :
+		mThreadCount(1), mQueued(0), mRemaining(0), mRunning(false) {
+}
+
+JobSystem&
+JobSystem::getInstance() {
+	static JobSystem *instance = new JobSystem();
+	return *instance;
+}
+
+void JobSystem::startUp(unsigned threadCount) {
+	mThreadCount = threadCount == 0 ? defaultThreadCount() : threadCount;
+	mRunning = true;
+	for (unsigned i = 0; i < mThreadCount; i++) {
+		mQueues.push_back(std::unique_ptr<Queue>(new Queue()));
+	}
+	for (unsigned i = 1; i < mThreadCount; i++) {
+		mWorkers.push_back(std::thread(&JobSystem::workerLoop, this, i));
+	}
+}
+
+void JobSystem::shutDown() {
+	{
+		std::lock_guard<std::mutex> lock(mWakeMutex);
+		mRunning = false;
+	}
+	mWake.notify_all();
+	for (auto &worker : mWorkers) {
+		worker.join();
+	}
+	mWorkers.clear();
+	mQueues.clear();
+	mThreadCount = 1;
+}
+
+unsigned JobSystem::defaultThreadCount() {
+	const char *value = std::getenv("ENGINE_THREADS");
+	int count = value != nullptr ? std::atoi(value) : 1;
+	return count > 0 ? static_cast<unsigned>(count) : 1;
+}
+
+std::size_t JobSystem::chunkCount(std::size_t count, std::size_t grain) {
+	if (grain == 0) {
+		grain = 1;
+	}
+	return (count + grain - 1) / grain;
+}
+
+// Deal the chunks out to every queue, then help until all are done
+void JobSystem::parallelFor(std::size_t count, std::size_t grain,
+		const RangeJob &job) {
+	if (grain == 0) {
+		grain = 1;
+	}
+	std::size_t chunks = chunkCount(count, grain);
+	if (mThreadCount <= 1 || mQueues.empty() || chunks <= 1
+			|| tThreadIndex >= 0) {
+		for (std::size_t chunk = 0; chunk < chunks; chunk++) {
+			std::size_t begin = chunk * grain;
+			job(begin, std::min(begin + grain, count), chunk);
+		}
+		return;
+	}
+
+	// counted before they are pushed, so a thief never takes the count below zero
+	mRemaining = chunks;
+	{
+		std::lock_guard<std::mutex> lock(mWakeMutex);
+		mQueued += chunks;
+	}
+	for (std::size_t chunk = 0; chunk < chunks; chunk++) {
+		std::size_t begin = chunk * grain;
+		Task task = { &job, begin, std::min(begin + grain, count), chunk };
+		Queue &queue = *mQueues[chunk % mQueues.size()];
+		std::lock_guard<std::mutex> lock(queue.mutex);
+		queue.tasks.push_back(task);
+	}
+	mWake.notify_all();
+
+	tThreadIndex = 0;
+	Task task;
+	while (mRemaining > 0) {
+		if (takeTask(0, task)) {
+			runTask(task);
+		} else {
+			std::this_thread::yield();
+		}
+	}
+	tThreadIndex = -1;
+}
+
+// Pop from the back of our own queue, or steal from the front of another
+bool JobSystem::takeTask(unsigned self, Task &task) {
+	{
+		Queue &own = *mQueues[self];
+		std::lock_guard<std::mutex> lock(own.mutex);
+		if (!own.tasks.empty()) {
+			task = own.tasks.back();
+			own.tasks.pop_back();
+			mQueued--;
+			return true;
+		}
+	}
+	for (std::size_t i = 1; i < mQueues.size(); i++) {
+		Queue &victim = *mQueues[(self + i) % mQueues.size()];
+		std::lock_guard<std::mutex> lock(victim.mutex);
+		if (!victim.tasks.empty()) {
+			task = victim.tasks.front();
+			victim.tasks.pop_front();
+			mQueued--;
+			return true;
+		}
+	}
+	return false;
+}
+
+void JobSystem::runTask(const Task &task) {
+	(*task.job)(task.begin, task.end, task.chunk);
+	mRemaining--;
+}
+
+void JobSystem::workerLoop(unsigned index) {
+	tThreadIndex = static_cast<int>(index);
+	ALLOC_SCOPE(WORKERS);
+	Task task;
+	while (true) {
+		if (takeTask(index, task)) {
+			runTask(task);
+			continue;
+		}
+		std::unique_lock<std::mutex> lock(mWakeMutex);
+		mWake.wait(lock, [this] {return mQueued > 0 || !mRunning;});
+		if (!mRunning) {
+			return;
+		}
+	}
+}
@@ -0,0 +1,92 @@
+#ifndef BASE_JOB_SYSTEM
+#define BASE_JOB_SYSTEM
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//! \brief A work-stealing thread pool for data-parallel loops.
+//!
+//! Each thread, the calling thread included, owns a queue of chunks.  A
+//! thread takes work from the back of its own queue and, once that is
+//! empty, steals from the front of the others.  With one thread there are
+//! no workers and every loop runs inline on the caller, in order.
+class JobSystem {
+private:
+
+	JobSystem(); // Private Singleton
+	JobSystem(JobSystem const&) = delete; // Avoid copy constructor.
+	void operator=(JobSystem const&) = delete; // Don't allow copy assignment.
+
+public:
+
+	//! A chunk of a loop: the range [begin, end) and the chunk's number.
+	typedef std::function<void(std::size_t begin, std::size_t end, std::size_t chunk)> RangeJob;
+
+	static JobSystem &getInstance(); //!< Get the instance.
+
+	/**
+	 * Start the pool
+	 * @param unsigned threadCount: threads to run loops on, including the
+	 * caller; 0 picks defaultThreadCount()
+	 */
+	void startUp(unsigned threadCount = 0);
+	void shutDown();
+
+	inline unsigned threadCount() const { return mThreadCount; } //!< Threads loops run on, including the caller.
+
+	/**
+	 * Return the thread count from the ENGINE_THREADS environment
+	 * variable, or 1 if it is not set
+	 */
+	static unsigned defaultThreadCount();
+
+	/**
+	 * Return the number of chunks parallelFor splits a loop into.  It
+	 * depends only on the arguments, never on the thread count.
+	 */
+	static std::size_t chunkCount(std::size_t count, std::size_t grain);
+
+	/**
+	 * Run job over [0, count) in chunks of at most grain elements and
+	 * return once every chunk is done.  Chunks may run in any order and on
+	 * any thread.  Called from inside a job, the loop runs inline.
+	 */
+	void parallelFor(std::size_t count, std::size_t grain, const RangeJob &job);
+
+private:
+
+	struct Task {
+		const RangeJob *job;
+		std::size_t begin, end, chunk;
+	};
+
+	//! A thread's queue; the owner uses the back, thieves the front.
+	struct Queue {
+		std::mutex mutex;
+		std::deque<Task> tasks;
+	};
+
+	bool takeTask(unsigned self, Task &task);
+	void runTask(const Task &task);
+	void workerLoop(unsigned index);
+
+	unsigned mThreadCount;
+	std::vector<std::unique_ptr<Queue>> mQueues; // one per thread, the caller's first
+	std::vector<std::thread> mWorkers;
+
+	std::mutex mWakeMutex;
+	std::condition_variable mWake;
+	std::atomic<std::size_t> mQueued; // tasks pushed and not yet taken
+	std::atomic<std::size_t> mRemaining; // tasks of the current loop not yet finished
+	bool mRunning;
+
+};
+
+#endif
@@ -1,4 +1,5 @@
 #include "LTimer.hpp"
+#include "SimulationClock.hpp"
 
 /**
  * A class for a Timer, taken from LazyFoo tutorials.
@@ -10,8 +11,9 @@
 /**
  * Constructor for an LTimer. Initializes variables.
  */
-LTimer::LTimer() {
+LTimer::LTimer(Source source) {
 	//Initialize the variables
+	mSource = source;
 	mStartTicks = 0;
 	mPausedTicks = 0;
 
@@ -30,7 +32,7 @@ void LTimer::start() {
 	mPaused = false;
 
 	//Get the current clock time
-	mStartTicks = SDL_GetTicks();
+	mStartTicks = now();
 	mPausedTicks = 0;
 }
 
@@ -59,7 +61,7 @@ void LTimer::pause() {
 		mPaused = true;
 
 		//Calculate the paused ticks
-		mPausedTicks = SDL_GetTicks() - mStartTicks;
+		mPausedTicks = now() - mStartTicks;
 		mStartTicks = 0;
 	}
 }
@@ -74,7 +76,7 @@ void LTimer::unpause() {
 		mPaused = false;
 
 		//Reset the starting ticks
-		mStartTicks = SDL_GetTicks() - mPausedTicks;
+		mStartTicks = now() - mPausedTicks;
 
 		//Reset the paused ticks
 		mPausedTicks = 0;
@@ -96,13 +98,23 @@ Uint32 LTimer::getTicks() {
 			time = mPausedTicks;
 		} else {
 			//Return the current time minus the start time
-			time = SDL_GetTicks() - mStartTicks;
+			time = now() - mStartTicks;
 		}
 	}
 
 	return time;
 }
 
+/**
+ * Gets the current time on the timer's clock.
+ */
+Uint32 LTimer::now() const {
+	if (mSource == SIMULATION_TIME) {
+		return SimulationClock::getInstance().ticks();
+	}
+	return SDL_GetTicks();
+}
+
 /**
  * Checks if the timer has been started.
  */
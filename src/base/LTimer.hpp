@@ -12,8 +12,14 @@
  */
 class LTimer {
 public:
+	//Which clock the timer reads
+	enum Source {
+		REAL_TIME, //SDL_GetTicks, for frame pacing and statistics
+		SIMULATION_TIME //the SimulationClock, for gameplay
+	};
+
 	//Initializes variables
-	LTimer();
+	LTimer(Source source = REAL_TIME);
 
 	//The various clock actions
 	void start();
@@ -32,6 +38,12 @@ public:
 	bool isPaused();
 
 private:
+	//The current time on the timer's clock
+	Uint32 now() const;
+
+	//The clock the timer reads
+	Source mSource;
+
 	//The clock time when the timer started
 	Uint32 mStartTicks;
 
@@ -1,25 +1,89 @@
 #include "base/Level.hpp"
+#include "base/AllocationTracker.hpp"
+#include "base/OwnershipStats.hpp"
 #include "base/PhysicsManager.hpp"
+#include "base/Profiler.hpp"
+#include "base/SimulationClock.hpp"
 #include <string>
 #include <algorithm>
 #include <iostream>
 
+namespace {
+
+// where this thread's adds and removes go while it runs a parallel batch
+thread_local LevelCommandBuffer *tCommands = nullptr;
+
+// The cached layer is drawn under the whole draw list, so only static
+// objects on the bottom layer can be drawn from it; the rest are drawn
+// with the moving objects, in their layer
+bool drawnFromStaticLayer(const GameObject &object) {
+	return object.isStatic() && object.renderComponent()
+			&& object.renderComponent()->layer() == 0;
+}
+
+}
+
+const float Level::DEFAULT_GRID_CELL_SIZE = 40.0f;
+const std::size_t Level::GRID_CELL_RESERVE;
+
 // Construct a level
 Level::Level(int w, int h, bool mode, int id) :
-		mW(w), mH(h), editingMode(mode), gameId(id) {
+		mW(w), mH(h), mWorldW(w), mWorldH(h), mGrid(DEFAULT_GRID_CELL_SIZE), editingMode(
+				mode), gameId(id) {
+	mCamera.setViewport(w, h);
+	mCamera.setBounds(w, h);
+	mStaticLayer.setChunkSize(w, h);
 }
 
 // Destroy the level
 Level::~Level() {
 }
 
+// Set the size of the world the camera looks at
+void Level::setWorldSize(int w, int h) {
+	mWorldW = w;
+	mWorldH = h;
+	mCamera.setBounds(w, h);
+}
+
+// Choose between per-object and data-oriented storage
+void Level::useComponentStore(bool enabled) {
+	if (enabled && !mStore) {
+		mStore.reset(new ComponentStore());
+	} else if (!enabled) {
+		mStore.reset();
+	}
+}
+
 // Finalize the new level for use
 void Level::finalize() {
+	mGrid.clear();
+	// objects moving about the screen then find their cells already made
+	mGrid.reserve(0, 0, mW, mH, GRID_CELL_RESERVE);
+	for (auto &objects : mTagIndex) {
+		objects.clear();
+	}
+	for (const auto &gameObject : mObjects) {
+		gameObject->deactivate();
+		gameObject->setHandle(ObjectHandle::null());
+	}
+	for (auto obj : mObjectsToRemove) {
+		obj->setRemovalQueued(false);
+	}
 	mObjects.clear();
 	mObjectsToAdd.clear();
 	mObjectsToRemove.clear();
 	mPlayer = 0;
 	mGoal = 0;
+	mCamera.follow(nullptr);
+	mCamera.moveTo(0, 0);
+	mStaticLayer.invalidate();
+	// nothing recorded is drawn once the level starts again, when the
+	// textures it names may be gone
+	for (Frame &frame : mFrames) {
+		frame.drawList.begin();
+		frame.staticCached = false;
+	}
 	score = 0;
 	lives = 3;
 	win = false;
@@ -27,22 +91,123 @@ void Level::finalize() {
 }
 
 // Add an object to the list of objects to add
-void Level::addObject(std::shared_ptr<GameObject> object) {
-	mObjectsToAdd.push_back(object);
+void Level::addObject(const std::shared_ptr<GameObject> &object) {
+	OwnershipStats::record();
+	addObject(std::shared_ptr<GameObject>(object));
+}
+
+// Add an object to the list of objects to add, taking the caller's share
+void Level::addObject(std::shared_ptr<GameObject> &&object) {
+	if (tCommands != nullptr) {
+		tCommands->added.push_back(std::move(object));
+		return;
+	}
+	mGrid.insert(*object);
+	mObjectsToAdd.push_back(std::move(object));
 }
 
 // Add an object to the list of objects to remove
-void Level::removeObject(std::shared_ptr<GameObject> object) {
-	auto elem = std::find(mObjectsToRemove.begin(), mObjectsToRemove.end(), object);
-	
-	if (elem == mObjectsToRemove.end()) {
-		mObjectsToRemove.push_back(object);
-		if (object->tag() == 5 || object->tag() == 3) {
+void Level::removeObject(const std::shared_ptr<GameObject> &object) {
+	removeObject(*object);
+}
+
+// Add an object to the list of objects to remove
+void Level::removeObject(GameObject &object) {
+	if (tCommands != nullptr) {
+		tCommands->removed.push_back(&object);
+		return;
+	}
+	if (queueRemoval(object)) {
+		if (object.tag() == 5 || object.tag() == 3) {
 			score++;
 		}
 	}
 }
 
+// Add the object a handle refers to to the list of objects to remove
+void Level::removeObject(ObjectHandle handle) {
+	std::shared_ptr<GameObject> *object = mObjects.get(handle);
+	if (object != nullptr) {
+		removeObject(**object);
+	}
+}
+
+void Level::setThreadCommandBuffer(LevelCommandBuffer *buffer) {
+	tCommands = buffer;
+}
+
+// Replay a worker's buffered calls now that no batch is running
+void Level::applyCommands(LevelCommandBuffer &buffer) {
+	for (auto &object : buffer.added) {
+		mGrid.insert(*object);
+		mObjectsToAdd.push_back(std::move(object));
+	}
+	for (auto object : buffer.removed) {
+		removeObject(*object);
+	}
+	buffer.added.clear();
+	buffer.removed.clear();
+}
+
+// Return the object a handle refers to
+GameObject* Level::getObject(ObjectHandle handle) {
+	std::shared_ptr<GameObject> *object = mObjects.get(handle);
+	return object != nullptr ? object->get() : nullptr;
+}
+
+// Queue an object for removal unless it already is; O(1) thanks to the flag
+bool Level::queueRemoval(GameObject &object) {
+	if (object.isRemovalQueued()) {
+		return false;
+	}
+	object.setRemovalQueued(true);
+	mObjectsToRemove.push_back(&object);
+	return true;
+}
+
+const std::vector<GameObject*>& Level::objectsWithTag(int tag) const {
+	static const std::vector<GameObject*> none;
+	if (tag < 0 || static_cast<std::size_t>(tag) >= mTagIndex.size()) {
+		return none;
+	}
+	return mTagIndex[tag];
+}
+
+// Tags are small integers, so the lists are indexed by tag directly
+void Level::indexTag(GameObject &object) {
+	int tag = object.tag();
+	if (tag < 0) {
+		return;
+	}
+	if (static_cast<std::size_t>(tag) >= mTagIndex.size()) {
+		mTagIndex.resize(tag + 1);
+	}
+	std::vector<GameObject*> &objects = mTagIndex[tag];
+	object.setTagSlot(objects.size());
+	objects.push_back(&object);
+}
+
+// Swap the last object with the tag into the hole
+void Level::unindexTag(GameObject &object) {
+	int tag = object.tag();
+	if (tag < 0) {
+		return;
+	}
+	std::vector<GameObject*> &objects = mTagIndex[tag];
+	std::size_t slot = object.tagSlot();
+	objects[slot] = objects.back();
+	objects[slot]->setTagSlot(slot);
+	objects.pop_back();
+}
+
+ObjectPool& Level::objectPool(const void *key) {
+	std::unique_ptr<ObjectPool> &pool = mPools[key];
+	if (!pool) {
+		pool.reset(new ObjectPool());
+	}
+	return *pool;
+}
+
 // Set the player to the given object
 void Level::setPlayer(std::shared_ptr<GameObject> player) {
 	mPlayer = player;
@@ -60,6 +225,7 @@ void Level::movePlayer(std::pair<int, int> position, float size) {
 	}
 	mPlayer->setX(position.first * size);
 	mPlayer->setY(position.second * size);
+	mGrid.update(*mPlayer);
 }
 
 // Move the goal to the specified position if available
@@ -69,60 +235,108 @@ void Level::moveGoal(std::pair<int, int> position, float size) {
 	}
 	mGoal->setX(position.first * size);
 	mGoal->setY(position.second * size);
+	mGrid.update(*mGoal);
 }
 
 // Update the level
 void Level::update() {
-	for (auto obj : mObjectsToAdd) {
-		mObjects.push_back(obj);
+	enterObjects();
+	updateComponents();
+	stepPhysics();
+	postStep();
+	removeObjects();
+}
+
+void Level::enterObjects() {
+	ALLOC_SCOPE(SPAWN);
+	// moved rather than copied, so entering the level costs no refcount
+	for (auto &obj : mObjectsToAdd) {
+		GameObject &gameObject = *obj;
+		gameObject.setHandle(mObjects.insert(std::move(obj)));
+		indexTag(gameObject);
+		gameObject.activate();
+		if (gameObject.isStatic()) {
+			mStaticLayer.invalidate(gameObject.x(), gameObject.y(),
+					gameObject.w(), gameObject.h());
+		}
 	}
 	mObjectsToAdd.clear();
+	// room to remove every object at once, so queuing removals never allocates
+	if (mObjectsToRemove.capacity() < mObjects.size()) {
+		mObjectsToRemove.reserve(2 * mObjects.size());
+	}
+}
 
-	bool hasBlocks = false;
-
-	bool hasEnemies = false;
-
-	for (auto gameObject : mObjects) {
-		gameObject->update();
-
-		if (gameId == 2) {
-
-			if (gameObject->tag() == 3) {
-				hasBlocks = true;
-			}
-
-			if (!hasBlocks) {
-				win = true;
-			}
+void Level::updateComponents() {
+	ALLOC_SCOPE(GAMEPLAY);
+	mSystems.update(*this);
 
-			if (gameObject->tag() == 6) {
-				if (gameObject->y() > mH) {
-					die = true;
-				}
+	// win and lose conditions come from the tag counts rather than a scan;
+	// an empty level has not been set up yet, so it has not been won
+	if (gameId == 2) {
+		if (!mObjects.empty() && tagCount(3) == 0) {
+			win = true;
+		}
+		for (auto ball : objectsWithTag(6)) {
+			if (ball->y() > mH) {
+				die = true;
 			}
 		}
+	}
 
-		if (gameId == 3) {
-
-			if (gameObject->tag() == 4) {
-				hasEnemies = true;
-			}
+	if (gameId == 3) {
+		if (!mObjects.empty() && tagCount(4) == 0) {
+			win = true;
+		}
+	}
+}
 
-			if (!hasEnemies) {
-				win = true;
+void Level::stepPhysics() {
+	ALLOC_SCOPE(PHYSICS);
+	// positions before the step, for drawing between steps
+	if (mStore) {
+		mStore->savePrevious();
+	} else {
+		for (const auto &gameObject : mObjects) {
+			if (gameObject->physicsComponent()) {
+				gameObject->savePrevious();
 			}
 		}
 	}
-
 	PhysicsManager::getInstance().step();
-	for (auto gameObject : mObjects) {
-		gameObject->postStep();
+	SimulationClock::getInstance().advance(
+			PhysicsManager::getInstance().timeStep());
+}
+
+void Level::postStep() {
+	PROFILE_SCOPE(POST_STEP);
+	ALLOC_SCOPE(POST_STEP);
+	if (mStore) {
+		mStore->postStep();
+	} else {
+		for (const auto &gameObject : mObjects) {
+			gameObject->postStep();
+		}
+	}
+	// only bodies the step can have moved need re-bucketing
+	for (const auto &gameObject : mObjects) {
+		const std::shared_ptr<PhysicsComponent> &physics =
+				gameObject->physicsComponent();
+		if (physics && physics->getBody()->IsAwake()
+				&& physics->getBody()->GetType() != b2_staticBody) {
+			mGrid.update(*gameObject);
+		}
 	}
+}
 
+void Level::removeObjects() {
+	PROFILE_SCOPE(REMOVAL);
+	ALLOC_SCOPE(REMOVAL);
 	for (auto obj : mObjectsToRemove) {
-		auto elem = std::find(mObjects.begin(), mObjects.end(), obj);
+		obj->setRemovalQueued(false);
+		ObjectHandle handle = obj->handle();
 
-		if (elem != mObjects.end()) {
+		if (mObjects.contains(handle)) {
 			if (!editingMode) {
 				if (obj->tag() == 2) {
 					win = true;
@@ -130,43 +344,129 @@ void Level::update() {
 					die = true;
 				}
 			}
-			mObjects.erase(elem);
+			if (obj->isStatic()) {
+				mStaticLayer.invalidate(obj->x(), obj->y(), obj->w(), obj->h());
+			}
+			obj->deactivate();
+			mGrid.remove(*obj);
+			unindexTag(*obj);
+			obj->setHandle(ObjectHandle::null());
+			// a spawned object nobody else holds goes back to its pool
+			std::shared_ptr<GameObject> &held = *mObjects.get(handle);
+			if (obj->pool() != nullptr && held.use_count() == 1) {
+				obj->pool()->release(std::move(held));
+			}
+			// may destroy obj, so done last
+			mObjects.erase(handle);
 		}
 	}
 	mObjectsToRemove.clear();
 }
 
 // Render the level
+// Only objects the camera sees are rendered, found through the grid, so
+// the cost follows what is on screen rather than the size of the level.
+// The view is widened by a cell to take in objects drawn part way back to
+// where the last step found them
 void Level::render(SDL_Renderer *renderer) {
-	for (auto gameObject : mObjects) {
-		gameObject->render(renderer);
+	record();
+	swapFrames();
+	prepareFrame(renderer);
+	draw(renderer);
+}
+
+void Level::record() {
+	ALLOC_SCOPE(RENDER);
+	Frame &frame = mFrames[mRecording];
+	mCamera.update();
+	frame.viewX = mCamera.x();
+	frame.viewY = mCamera.y();
+	// static objects on layer 0 come from the cached layer, under
+	// everything else, if it was ready when the frame was recorded
+	frame.staticCached = mStaticLayer.ready();
+	frame.drawList.begin();
+	const float margin = mGrid.cellSize();
+	mVisible.clear();
+	mGrid.queryRect(mCamera.x() - margin, mCamera.y() - margin,
+			mCamera.w() + 2 * margin, mCamera.h() + 2 * margin, mVisible);
+	for (GameObject *gameObject : mVisible) {
+		// objects waiting to enter the level are in the grid already
+		if (gameObject->isActive()
+				&& !(frame.staticCached && drawnFromStaticLayer(*gameObject))) {
+			gameObject->render(nullptr);
+		}
 	}
 }
 
-// Return the object at the specified position
-std::shared_ptr<GameObject> Level::getObjectAtPosition(
-		std::pair<int, int> mousePosition, float size) {
-	auto elem = std::find_if(mObjects.begin(), mObjects.end(),
-			[mousePosition, size](std::shared_ptr<GameObject> obj) {
-				return (trunc(obj->x() / size) == mousePosition.first
-						&& trunc(obj->y() / size) == mousePosition.second);
-			});
+void Level::swapFrames() {
+	mRecording ^= 1;
+}
 
-	if (elem != mObjects.end()) {
-		return *elem;
-	}
+void Level::prepareFrame(SDL_Renderer *renderer) {
+	const Frame &frame = mFrames[mRecording ^ 1];
+	mStaticLayer.prepare(renderer, *this, frame.viewX, frame.viewY);
+}
 
-	elem = std::find_if(mObjectsToAdd.begin(), mObjectsToAdd.end(),
-			[mousePosition, size](std::shared_ptr<GameObject> obj) {
-				return (trunc(obj->x() / size) == mousePosition.first
-						&& trunc(obj->y() / size) == mousePosition.second);
-			});
+void Level::draw(SDL_Renderer *renderer) {
+	Frame &frame = mFrames[mRecording ^ 1];
+	if (frame.staticCached) {
+		mStaticLayer.draw(renderer);
+	}
+	frame.drawList.render(renderer);
+}
 
-	if (elem != mObjectsToAdd.end()) {
-		return *elem;
+// Drawn through the camera, moved to the area for the purpose
+void Level::renderStatic(SDL_Renderer *renderer, const SDL_Rect &area) {
+	const float cameraX = mCamera.x();
+	const float cameraY = mCamera.y();
+	mCamera.setPosition(area.x, area.y);
+	// the frame to record next is free until the next record begins it
+	DrawList &list = drawList();
+	list.begin();
+	mVisible.clear();
+	mGrid.queryRect(area.x, area.y, area.w, area.h, mVisible);
+	for (GameObject *gameObject : mVisible) {
+		if (gameObject->isActive() && drawnFromStaticLayer(*gameObject)) {
+			gameObject->render(renderer);
+		}
 	}
+	list.render(renderer);
+	mCamera.setPosition(cameraX, cameraY);
+}
+
+// The range of coordinates that trunc(c / size) maps to column c.  trunc
+// rounds toward zero, so column 0 is two cells wide.
+static void truncatedRange(int c, float size, float &lo, float &hi) {
+	lo = (c > 0 ? c : c - 1) * size;
+	hi = (c >= 0 ? c + 1 : c) * size;
+}
 
-	return NULL;
+// Return the object whose top-left corner is in the specified cell,
+// preferring objects already in the level over ones waiting to enter it
+std::shared_ptr<GameObject> Level::getObjectAtPosition(
+		std::pair<int, int> mousePosition, float size) {
+	float x0, x1, y0, y1;
+	truncatedRange(mousePosition.first, size, x0, x1);
+	truncatedRange(mousePosition.second, size, y0, y1);
+	mQueryResults.clear();
+	// padded by a unit so corners on the far edges are still candidates
+	mGrid.queryRect(x0 - 1, y0 - 1, x1 - x0 + 2, y1 - y0 + 2, mQueryResults);
+
+	GameObject *found = nullptr;
+	for (auto obj : mQueryResults) {
+		if (trunc(obj->x() / size) == mousePosition.first
+				&& trunc(obj->y() / size) == mousePosition.second) {
+			if (found == nullptr
+					|| (found->handle().isNull() && !obj->handle().isNull())) {
+				found = obj;
+			}
+		}
+	}
+	if (found == nullptr) {
+		return NULL;
+	}
+	OwnershipStats::record();
+	return found->shared_from_this();
 }
 
 // Remove the object at the mouse position
@@ -182,7 +482,7 @@ void Level::removeObjectAtMouse(std::pair<int, int> mousePosition, float size) {
 		mGoal = 0;
 	}
 
-	mObjectsToRemove.push_back(obj);
+	queueRemoval(*obj);
 }
 
 // Export the level
@@ -1,15 +1,33 @@
 #ifndef BASE_LEVEL
 #define BASE_LEVEL
 
+#include "base/Camera.hpp"
+#include "base/ComponentStore.hpp"
+#include "base/ComponentSystem.hpp"
+#include "base/DrawList.hpp"
 #include "base/GameObject.hpp"
+#include "base/ObjectPool.hpp"
+#include "base/PoolAllocator.hpp"
+#include "base/SlotMap.hpp"
+#include "base/SpatialGrid.hpp"
+#include "base/StaticLayer.hpp"
 #include <SDL.h>
 #include <memory>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 #include <fstream>
 #include <algorithm>
 #include <math.h>
 #include <iostream>
 
+//! \brief Objects added and removed by a component updating on a worker
+//! thread, kept until the level applies them.
+struct LevelCommandBuffer {
+  std::vector<std::shared_ptr<GameObject>> added;
+  std::vector<GameObject*> removed;
+};
+
 //! \brief A level in the game.  Essentially manages a collection of game
 //! objects, and does some collision detection.
 class Level {
@@ -46,6 +64,51 @@ public:
    */
   void finalize();
 
+  /**
+   * Switch the level to data-oriented storage, where object transforms
+   * and components are kept in a ComponentStore.  Must be called while
+   * the level has no objects, e.g. from the constructor.
+   * @param bool enabled: whether to use the store
+   */
+  void useComponentStore(bool enabled);
+
+  /**
+   * Return the component store, or nullptr when the level keeps its data
+   * in the game objects
+   */
+  inline ComponentStore * componentStore() { return mStore.get(); }
+
+  /**
+   * Return the registry that updates the generic components of the
+   * objects in the level, batched by component type
+   */
+  inline ComponentRegistry & componentSystems() { return mSystems; }
+
+  static const float DEFAULT_GRID_CELL_SIZE; //!< Cell size of the spatial index unless set otherwise.
+  static const std::size_t GRID_CELL_RESERVE = 4; //!< Objects each on-screen cell has room for from the start.
+
+  /**
+   * Return the spatial index of the objects in the level, including ones
+   * waiting to enter it, for point, cell and rectangle queries
+   */
+  inline const SpatialGrid & grid() const { return mGrid; }
+
+  /**
+   * Return the list render components queue their rectangles and sprites
+   * in while the level records a frame; it is drawn, sorted by layer, once
+   * the frame is swapped in
+   */
+  inline DrawList & drawList() { return mFrames[mRecording].drawList; }
+
+  inline int drawCalls() const { return mFrames[mRecording ^ 1].drawList.drawCalls(); } //!< Calls made to the renderer drawing the last frame.
+
+  /**
+   * Set the cell size of the spatial index; about the size of a typical
+   * object works best.  Must be called while the level has no objects.
+   * @param float cellSize: width and height of a cell
+   */
+  inline void setGridCellSize(float cellSize) { mGrid.setCellSize(cellSize); }
+
   /**
    * Return the width
    */
@@ -57,16 +120,138 @@ public:
   inline int h() const { return mH; }
 
   /**
-   * Set an object to be added
+   * Set the size of the world, which may be larger than the view of it the
+   * level's width and height give; the camera stays inside it
+   * @param int w: width of the world
+   * @param int h: height of the world
+   */
+  void setWorldSize(int w, int h);
+
+  inline int worldW() const { return mWorldW; } //!< Width of the world; the level's width unless set.
+  inline int worldH() const { return mWorldH; } //!< Height of the world; the level's height unless set.
+
+  /**
+   * Return the camera the level is drawn through.  Only objects it can
+   * see are rendered.
+   */
+  inline Camera & camera() { return mCamera; }
+  inline const Camera & camera() const { return mCamera; }
+
+  /**
+   * Draw the static objects again before the next frame, e.g. after the
+   * renderer lost its render targets
+   */
+  inline void invalidateStaticLayer() { mStaticLayer.invalidate(); }
+
+  /**
+   * Destroy the textures the level keeps for drawing, before the renderer
+   * they belong to is destroyed; they are made again if needed
+   */
+  inline void releaseTextures() { mStaticLayer.release(); }
+
+  /**
+   * Set an object to be added.  It gets its handle when it enters the
+   * level at the start of the next update.
    * @param std::shared_ptr<GameObject> object: the object to be added
    */
-  void addObject(std::shared_ptr<GameObject> object);
+  void addObject(const std::shared_ptr<GameObject> &object);
+
+  /**
+   * Set an object to be added, moving the caller's shared_ptr in rather
+   * than copying it
+   * @param std::shared_ptr<GameObject>&& object: the object to be added
+   */
+  void addObject(std::shared_ptr<GameObject> &&object);
+
+  /**
+   * Add an object of type T, reusing one that left the level earlier if
+   * there is one.  New objects are made with makePooled, so the object
+   * and its control block share one arena allocation.  A reused object is
+   * passed the same arguments, minus the level, through T::respawn, which
+   * must put it back in its just-constructed state.  Spawned objects go
+   * back to the pool when removed, unless something else still holds them.
+   * The object is moved between the pool and the level, never copied, and
+   * is lent to the caller rather than shared.
+   * @param Args&&... args: the arguments for T's constructor after the level
+   */
+  template<typename T, typename... Args>
+  T & spawn(Args&&... args) {
+    ObjectPool &pool = objectPool(poolKey<T>());
+    std::shared_ptr<GameObject> object = pool.take();
+    if (object) {
+      static_cast<T&>(*object).respawn(std::forward<Args>(args)...);
+      if (object->physicsComponent()) {
+        object->physicsComponent()->setEnabled(true);
+      }
+    } else {
+      object = makePooled<T>(*this, std::forward<Args>(args)...);
+      object->setPool(&pool);
+      pool.made();
+    }
+    T &spawned = static_cast<T&>(*object);
+    addObject(std::move(object));
+    return spawned;
+  }
 
   /**
-   * Set an object to be removed
+   * Set an object to be removed.  Queuing the same object more than once
+   * has no further effect.
    * @param std::shared_ptr<GameObject> object: the object to be removed
    */
-  void removeObject(std::shared_ptr<GameObject> object);
+  void removeObject(const std::shared_ptr<GameObject> &object);
+
+  /**
+   * Set an object to be removed, borrowing it rather than sharing
+   * ownership, for use from collision handlers
+   * @param GameObject& object: the object to be removed
+   */
+  void removeObject(GameObject &object);
+
+  /**
+   * Set the object a handle refers to to be removed; stale handles are
+   * ignored
+   * @param ObjectHandle handle: handle of the object to be removed
+   */
+  void removeObject(ObjectHandle handle);
+
+  /**
+   * Return the object a handle refers to, or nullptr if it has left the
+   * level
+   * @param ObjectHandle handle: the handle to look up
+   */
+  GameObject * getObject(ObjectHandle handle);
+
+  /**
+   * Return the objects in the level with a tag, in no particular order.
+   * Kept up to date as objects enter and leave, so this costs nothing.
+   * @param int tag: the tag to look up
+   */
+  const std::vector<GameObject*> & objectsWithTag(int tag) const;
+
+  /**
+   * Return the number of objects in the level with a tag
+   * @param int tag: the tag to count
+   */
+  inline std::size_t tagCount(int tag) const { return objectsWithTag(tag).size(); }
+
+  /**
+   * Make addObject and removeObject calls on this thread go to a buffer
+   * instead of the level, until called again with nullptr
+   * @param LevelCommandBuffer* buffer: the buffer to record into
+   */
+  static void setThreadCommandBuffer(LevelCommandBuffer *buffer);
+
+  /**
+   * Apply the adds and removes recorded in a buffer, in the order they
+   * were made, and empty it
+   * @param LevelCommandBuffer& buffer: the buffer to apply
+   */
+  void applyCommands(LevelCommandBuffer &buffer);
+
+  /**
+   * Return the number of objects in the level
+   */
+  inline std::size_t objectCount() const { return mObjects.size(); }
   
   /**
    * Sets a player object
@@ -89,7 +274,8 @@ public:
   void moveGoal(std::pair<int, int> position, float size);
 
   /**
-   * Returns the object at the specified position
+   * Returns the object whose top-left corner is in the specified cell.
+   * Uses the spatial index, so it costs a few grid cells, not a scan.
    */
   std::shared_ptr<GameObject> getObjectAtPosition(std::pair<int, int> mousePosition, float size);
 
@@ -99,15 +285,43 @@ public:
   void removeObjectAtMouse(std::pair<int, int> mousePosition, float size);
 
   /**
-   * Update objects in level
+   * Update objects in level: runs the phases below, in order
    */
   void update();
 
+  // The phases of an update.  Called separately only to measure them, and
+  // then always all of them, in this order.
+  void enterObjects(); //!< Bring objects added since the last update into the level.
+  void updateComponents(); //!< Update the generic components and check win and lose conditions.
+  void stepPhysics(); //!< Step the physics world and the simulation clock.
+  void postStep(); //!< Copy the new physics positions into the objects and the grid.
+  void removeObjects(); //!< Take out the objects queued for removal.
+
   /**
-   * Render the level
+   * Render the level: record, swapFrames, prepareFrame and draw, in turn
    */
   void render(SDL_Renderer * renderer);
 
+  // Rendering in parts, so the next frame can be simulated and recorded
+  // while this one is drawn.  Frames are double-buffered: record fills one
+  // while draw reads the other.
+  void record(); //!< Queue what the camera sees into the frame being recorded; makes no SDL calls.
+  void swapFrames(); //!< Make the frame just recorded the one to draw, and record into the other.
+  void prepareFrame(SDL_Renderer * renderer); //!< Bring the static layer up to date for the frame to draw; reads the objects, so not while they change.
+  void draw(SDL_Renderer * renderer); //!< Draw the frame swapped in; reads nothing record writes.
+
+  /**
+   * Set how far rendering is between the last two physics steps, so
+   * moving objects are drawn between their previous and current positions
+   * @param float alpha: 0 for the previous step, 1 for the current one
+   */
+  inline void setInterpolation(float alpha) { mInterpolation = alpha; }
+
+  /**
+   * Return how far rendering is between the last two physics steps
+   */
+  inline float interpolation() const { return mInterpolation; }
+
   /**
    * Return score for display purposes
    */
@@ -146,8 +360,46 @@ private:
   Level(const Level &) = delete;
   void operator=(Level const&) = delete;
 
+  friend class StaticLayer;
+  void renderStatic(SDL_Renderer *renderer, const SDL_Rect &area); //!< Draw the cached static objects in an area, with the area's top left at 0, 0; only between frames.
+
+  bool queueRemoval(GameObject &object); //!< Queue an object for removal; false if it already was.
+
+  ObjectPool & objectPool(const void *key); //!< The pool for a spawned type, made on first use.
+
+  void indexTag(GameObject &object); //!< Add an object entering the level to its tag's list.
+  void unindexTag(GameObject &object); //!< Take an object leaving the level out of its tag's list.
+
+  //! An address unique to T, naming its pool.
+  template<typename T>
+  static const void * poolKey() {
+    static const char key = 0;
+    return &key;
+  }
+
   int mW, mH;
-  std::vector<std::shared_ptr<GameObject>> mObjects;
+  int mWorldW, mWorldH;
+  // declared before the objects so they outlive them
+  std::unique_ptr<ComponentStore> mStore;
+  ComponentRegistry mSystems;
+  SlotMap<std::shared_ptr<GameObject>> mObjects;
+  std::unordered_map<const void*, std::unique_ptr<ObjectPool>> mPools;
+  SpatialGrid mGrid;
+  std::vector<std::vector<GameObject*>> mTagIndex; // objects in the level, by tag
+  std::vector<GameObject*> mQueryResults; // reused by position queries
+  Camera mCamera;
+  std::vector<GameObject*> mVisible; // reused by render
+
+  //! A recorded frame.
+  struct Frame {
+    DrawList drawList;
+    bool staticCached = false; // static objects left to mStaticLayer
+    float viewX = 0.0f, viewY = 0.0f; // where the camera was
+  };
+  Frame mFrames[2];
+  int mRecording = 0; // index of the frame being recorded; the other is drawn
+  StaticLayer mStaticLayer;
+  float mInterpolation = 1.0f;
   int score = 0;
   int lives = 3;
   bool spedUp = false;
@@ -155,7 +407,8 @@ private:
   bool editingMode;
   int gameId;
   std::vector<std::shared_ptr<GameObject>> mObjectsToAdd;
-  std::vector<std::shared_ptr<GameObject>> mObjectsToRemove;
+  // raw pointers: every queued object is still held by mObjects or mObjectsToAdd
+  std::vector<GameObject*> mObjectsToRemove;
   bool win = false;
   bool die = false;
 
@@ -0,0 +1,33 @@
+#include "base/ObjectPool.hpp"
+#include "base/GameObject.hpp"
+
+ObjectPool::ObjectPool() :
+		mMade(0) {
+}
+
+ObjectPool::~ObjectPool() {
+}
+
+// Park the body so it neither collides nor costs the broad-phase anything
+void ObjectPool::release(std::shared_ptr<GameObject> &&object) {
+	const std::shared_ptr<PhysicsComponent> &physics = object->physicsComponent();
+	if (physics) {
+		physics->setEnabled(false);
+	}
+	mObjects.push_back(std::move(object));
+}
+
+void ObjectPool::made() {
+	if (++mMade > mObjects.capacity()) {
+		mObjects.reserve(2 * mMade);
+	}
+}
+
+std::shared_ptr<GameObject> ObjectPool::take() {
+	if (mObjects.empty()) {
+		return nullptr;
+	}
+	std::shared_ptr<GameObject> object = std::move(mObjects.back());
+	mObjects.pop_back();
+	return object;
+}
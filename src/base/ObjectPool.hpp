@@ -0,0 +1,49 @@
+#ifndef BASE_OBJECT_POOL
+#define BASE_OBJECT_POOL
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+class GameObject;
+
+//! \brief Game objects of one type that have left their level and wait to
+//! be spawned again.  A pooled object keeps its components, its transform
+//! slot and its physics body; the body is only disabled while it waits.
+class ObjectPool {
+public:
+
+	ObjectPool();
+	~ObjectPool();
+
+	/**
+	 * Take back an object that has left the level
+	 * @param std::shared_ptr<GameObject>&& object: the object; the pool must hold its only reference
+	 */
+	void release(std::shared_ptr<GameObject> &&object);
+
+	/**
+	 * Note that a new object was made for the pool, so that it has room to
+	 * take back every object it has handed out without allocating
+	 */
+	void made();
+
+	/**
+	 * Hand out a waiting object, or nullptr if there is none.  The caller
+	 * resets it and adds it back to the level.
+	 */
+	std::shared_ptr<GameObject> take();
+
+	inline std::size_t size() const { return mObjects.size(); } //!< Objects waiting.
+
+private:
+
+	ObjectPool(const ObjectPool&) = delete;
+	void operator=(ObjectPool const&) = delete;
+
+	std::vector<std::shared_ptr<GameObject>> mObjects;
+	std::size_t mMade;
+
+};
+
+#endif
@@ -0,0 +1,32 @@
+#include "base/OwnershipStats.hpp"
+
+std::atomic<unsigned int> OwnershipStats::sCurrent(0);
+unsigned int OwnershipStats::sLastFrame = 0;
+unsigned int OwnershipStats::sPeak = 0;
+
+void
+OwnershipStats::record(unsigned int count)
+{
+  sCurrent.fetch_add(count, std::memory_order_relaxed);
+}
+
+void
+OwnershipStats::endFrame()
+{
+  sLastFrame = sCurrent.exchange(0, std::memory_order_relaxed);
+  if (sLastFrame > sPeak) {
+    sPeak = sLastFrame;
+  }
+}
+
+unsigned int
+OwnershipStats::lastFrame()
+{
+  return sLastFrame;
+}
+
+unsigned int
+OwnershipStats::peak()
+{
+  return sPeak;
+}
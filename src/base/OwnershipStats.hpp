@@ -0,0 +1,30 @@
+#ifndef BASE_OWNERSHIP_STATS
+#define BASE_OWNERSHIP_STATS
+
+#include <atomic>
+
+//! \brief Counts the shared_ptr copies a level makes of its objects: ones
+//! added by copy rather than moved in, and ones it hands out.
+//!
+//! Steady-state frames should make none; the per-frame paths borrow
+//! objects and components by reference, and spawning moves objects in
+//! and out of their pools.  A headless run with --check-allocs fails if a
+//! tick past the warm-up records one.
+class OwnershipStats {
+public:
+
+  static void record(unsigned int count = 1); //!< Record copies.
+  static void endFrame(); //!< Close the current frame's tally.
+
+  static unsigned int lastFrame(); //!< Copies counted in the last finished frame.
+  static unsigned int peak(); //!< Largest per-frame count so far.
+
+private:
+
+  static std::atomic<unsigned int> sCurrent;
+  static unsigned int sLastFrame;
+  static unsigned int sPeak;
+
+};
+
+#endif
@@ -25,6 +25,8 @@ PatrolComponent::PatrolComponent(GameObject &gameObject, float toX, float toY,
 	speedX = startVx;
 	speedY = startVy;
 
+	setCollisionTags(NO_TAGS);
+
 	if (destX < startX) {
 		speedX *= -1;
 	}
@@ -67,7 +69,7 @@ void PatrolComponent::update(Level &level) {
 		}
 	}
 
-	std::shared_ptr<PhysicsComponent> pc = obj.physicsComponent();
+	PhysicsComponent *pc = obj.physicsComponent().get();
 	pc->setVx(speedX);
 	pc->setVy(speedY);
 }
@@ -7,6 +7,10 @@
 class PatrolComponent: public GenericComponent {
 public:
 
+  // only steers its own body, so patrols can update in parallel
+  static const unsigned READS = ACCESS_OWNER;
+  static const unsigned WRITES = ACCESS_OWNER;
+
   PatrolComponent(GameObject & gameObject, float toX, float toY, float speed);
   
   virtual void update(Level & level);
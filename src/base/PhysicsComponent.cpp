@@ -41,8 +41,13 @@ PhysicsComponent::PhysicsComponent(GameObject &gameObject, Type type) :
 	mBody->CreateFixture(&fixtureDef);
 }
 
+// Objects kept past shutdown, such as pooled ones, find the world gone
+// and their bodies already freed with it
 PhysicsComponent::~PhysicsComponent() {
-	PhysicsManager::getInstance().getWorld()->DestroyBody(mBody);
+	b2World *world = PhysicsManager::getInstance().getWorld();
+	if (world != nullptr) {
+		world->DestroyBody(mBody);
+	}
 	mBody = nullptr;
 }
 
@@ -80,6 +85,21 @@ void PhysicsComponent::postStep() {
 					- 0.5f * gameObject.h());
 }
 
+// Used when a pooled object is spawned again
+void PhysicsComponent::reset() {
+	GameObject &gameObject = getGameObject();
+	b2Vec2 position((gameObject.x() + 0.5f * gameObject.w())
+			* PhysicsManager::GAME_TO_PHYSICS_SCALE,
+			(gameObject.y() + 0.5f * gameObject.h())
+					* PhysicsManager::GAME_TO_PHYSICS_SCALE);
+	mBody->SetTransform(position, 0.0f);
+	mBody->SetLinearVelocity(b2Vec2(0.0f, 0.0f));
+}
+
+void PhysicsComponent::setEnabled(bool enabled) {
+	mBody->SetActive(enabled);
+}
+
 b2Body*
 PhysicsComponent::getBody() {
 	return mBody;
@@ -26,6 +26,9 @@ public:
   void addFy(float fy); //!< add force in y direction
 
   void postStep(); //!< Called after physics step.
+
+  void reset(); //!< Move the body to the object's position and stop it.
+  void setEnabled(bool enabled); //!< Take the body in or out of the simulation.
   b2Body* getBody();
 private:
 
@@ -1,5 +1,6 @@
 #include "PhysicsManager.hpp"
 #include "GameObject.hpp"
+#include "Profiler.hpp"
 
 PhysicsManager&
 PhysicsManager::getInstance() {
@@ -9,6 +10,7 @@ PhysicsManager::getInstance() {
 
 void PhysicsManager::startUp() {
 	mWorld = new b2World(b2Vec2(0.0f, 0.0f));
+	mListeners.assign(TAG_SLOTS * TAG_SLOTS, 0);
 }
 
 void PhysicsManager::shutDown() {
@@ -17,11 +19,12 @@ void PhysicsManager::shutDown() {
 }
 
 void PhysicsManager::step() {
-	const float timeStep = 1.0f / 60.0f;
 	const int velocityIterations = 6;
 	const int positionIterations = 2;
+	PROFILE_SCOPE(PHYSICS);
 
-	mWorld->Step(timeStep, velocityIterations, positionIterations);
+	mWorld->Step(mTimeStep, velocityIterations, positionIterations);
+	PROFILE_PHYSICS_STEP(mWorld);
 
 	b2Contact *contact = mWorld->GetContactList();
 	while (contact) {
@@ -31,31 +34,54 @@ void PhysicsManager::step() {
 			GameObject *objB =
 					static_cast<GameObject*>(contact->GetFixtureB()->GetBody()->GetUserData());
 
-			objA->collision(objB->shared_from_this());
-			objB->collision(objA->shared_from_this());
+			// the table skips contacts neither side has asked about
+			if (isListening(objA->tag(), objB->tag())) {
+				objA->collision(*objB);
+			}
+			if (isListening(objB->tag(), objA->tag())) {
+				objB->collision(*objA);
+			}
 		}
 		contact = contact->GetNext();
 	}
 }
 
+void PhysicsManager::subscribe(int tag, std::uint64_t otherTags) {
+	unsigned int *row = &mListeners[tagSlot(tag) * TAG_SLOTS];
+	for (int other = 0; other < TAG_SLOTS; other++) {
+		if (otherTags & (std::uint64_t(1) << other)) {
+			row[other]++;
+		}
+	}
+}
+
+void PhysicsManager::unsubscribe(int tag, std::uint64_t otherTags) {
+	unsigned int *row = &mListeners[tagSlot(tag) * TAG_SLOTS];
+	for (int other = 0; other < TAG_SLOTS; other++) {
+		if (otherTags & (std::uint64_t(1) << other)) {
+			row[other]--;
+		}
+	}
+}
+
 class QueryCallbackHelper: public b2QueryCallback {
 public:
-	QueryCallbackHelper(std::vector<std::shared_ptr<GameObject>> &objects) :
+	QueryCallbackHelper(std::vector<GameObject*> &objects) :
 			mObjects(objects) {
 	}
 
 	bool ReportFixture(b2Fixture *fixture) {
 		GameObject *obj =
 				static_cast<GameObject*>(fixture->GetBody()->GetUserData());
-		mObjects.push_back(obj->shared_from_this());
+		mObjects.push_back(obj);
 		return true;
 	}
 private:
-	std::vector<std::shared_ptr<GameObject>> &mObjects;
+	std::vector<GameObject*> &mObjects;
 };
 
 bool PhysicsManager::getCollisions(float rx, float ry, float rw, float rh,
-		std::vector<std::shared_ptr<GameObject>> &objects) const {
+		std::vector<GameObject*> &objects) const {
 	objects.clear();
 	QueryCallbackHelper qcb(objects);
 
@@ -1,4 +1,8 @@
+#ifndef BASE_PHYSICS_MANAGER
+#define BASE_PHYSICS_MANAGER
+
 #include <Box2D/Box2D.h>
+#include <cstdint>
 #include <vector>
 
 class GameObject;
@@ -20,9 +24,26 @@ public:
   void startUp();
   void shutDown();
 
-  void step(); //!< Step physics.
+  static constexpr float DEFAULT_TIME_STEP = 1.0f / 60.0f; //!< Seconds simulated per step unless set otherwise.
+
+  void step(); //!< Step physics by the fixed time step.
+
+  inline float timeStep() const { return mTimeStep; } //!< Seconds simulated per step.
+  inline void setTimeStep(float seconds) { mTimeStep = seconds; } //!< Set the seconds simulated per step.
+
+  static const int TAG_SLOTS = 64; //!< Tags tracked apart in the collision table; higher tags share the last slot.
+
+  static inline int tagSlot(int tag) { return (tag >= 0 && tag < TAG_SLOTS - 1) ? tag : TAG_SLOTS - 1; }
 
-  bool getCollisions(float rx, float ry, float rw, float rh, std::vector<std::shared_ptr<GameObject>> & objects) const; //!< Get objects colliding with a given rect. Returns true if there were any objects.
+  void subscribe(int tag, std::uint64_t otherTags); //!< Note that an object with tag wants to hear about contacts with otherTags.
+  void unsubscribe(int tag, std::uint64_t otherTags); //!< Undo a subscribe with the same arguments.
+
+  //! Whether any object with tag wants to hear about contacts with otherTag.
+  inline bool isListening(int tag, int otherTag) const {
+    return mListeners[tagSlot(tag) * TAG_SLOTS + tagSlot(otherTag)] != 0;
+  }
+
+  bool getCollisions(float rx, float ry, float rw, float rh, std::vector<GameObject*> & objects) const; //!< Get objects colliding with a given rect. Returns true if there were any objects.
 
   inline b2World *getWorld() { return mWorld; } //!< Get the world.
   inline const b2World *getWorld() const { return mWorld; } //!< Get the world.
@@ -31,4 +52,11 @@ private:
 
   b2World *mWorld;
 
+  float mTimeStep = DEFAULT_TIME_STEP;
+
+  // for each (tag, other tag) pair, how many objects want those contacts
+  std::vector<unsigned int> mListeners;
+
 };
+
+#endif
@@ -0,0 +1,71 @@
+#include "base/PoolAllocator.hpp"
+#include <cstdint>
+
+PoolArena::PoolArena():
+  mCursor(nullptr),
+  mEnd(nullptr)
+{
+  for (std::size_t i = 0; i < CLASS_COUNT; i++) {
+    mFree[i] = nullptr;
+  }
+}
+
+PoolArena &
+PoolArena::getInstance()
+{
+  static PoolArena * instance = new PoolArena();
+  return *instance;
+}
+
+void *
+PoolArena::allocate(std::size_t bytes)
+{
+  std::size_t sizeClass = (bytes + ALIGNMENT - 1) / ALIGNMENT;
+  if (sizeClass == 0) {
+    sizeClass = 1;
+  }
+  if (sizeClass > CLASS_COUNT) {
+    return ::operator new(bytes);
+  }
+
+  std::lock_guard<std::mutex> lock(mMutex);
+  FreeNode * node = mFree[sizeClass - 1];
+  if (node != nullptr) {
+    mFree[sizeClass - 1] = node->next;
+    return node;
+  }
+  // carve from the current block, starting a new one when it runs out;
+  // the tail of the old block is simply left unused
+  std::size_t size = sizeClass * ALIGNMENT;
+  if (mCursor == nullptr || static_cast<std::size_t>(mEnd - mCursor) < size) {
+    mBlocks.push_back(std::unique_ptr<char[]>(new char[BLOCK_SIZE + ALIGNMENT]));
+    char * start = mBlocks.back().get();
+    std::size_t misalignment = reinterpret_cast<std::uintptr_t>(start) % ALIGNMENT;
+    mCursor = start + (misalignment == 0 ? 0 : ALIGNMENT - misalignment);
+    mEnd = mCursor + BLOCK_SIZE;
+  }
+  void * pointer = mCursor;
+  mCursor += size;
+  return pointer;
+}
+
+void
+PoolArena::deallocate(void * pointer, std::size_t bytes)
+{
+  if (pointer == nullptr) {
+    return;
+  }
+  std::size_t sizeClass = (bytes + ALIGNMENT - 1) / ALIGNMENT;
+  if (sizeClass == 0) {
+    sizeClass = 1;
+  }
+  if (sizeClass > CLASS_COUNT) {
+    ::operator delete(pointer);
+    return;
+  }
+
+  std::lock_guard<std::mutex> lock(mMutex);
+  FreeNode * node = static_cast<FreeNode *>(pointer);
+  node->next = mFree[sizeClass - 1];
+  mFree[sizeClass - 1] = node;
+}
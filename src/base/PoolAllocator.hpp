@@ -0,0 +1,82 @@
+#ifndef BASE_POOL_ALLOCATOR
+#define BASE_POOL_ALLOCATOR
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <utility>
+#include <vector>
+
+//! \brief A small-object arena.  Requests are rounded up to a size class
+//! and served from that class's free list, which is refilled from large
+//! blocks; freed memory goes back on the list rather than to the heap, so
+//! once a scene has warmed up, spawning and destroying objects does not
+//! call malloc.  Requests too big for any class use the heap directly.
+class PoolArena {
+private:
+
+  PoolArena(); // Private Singleton
+  PoolArena(PoolArena const&) = delete; // Avoid copy constructor.
+  void operator=(PoolArena const&) = delete; // Don't allow copy assignment.
+
+public:
+
+  static PoolArena &getInstance(); //!< Get the instance.
+
+  void * allocate(std::size_t bytes); //!< Allocate memory for bytes bytes.
+  void deallocate(void * pointer, std::size_t bytes); //!< Give memory back; bytes must match the allocation.
+
+  inline std::size_t blockCount() const { return mBlocks.size(); } //!< Blocks taken from the heap so far.
+
+private:
+
+  static const std::size_t ALIGNMENT = 16;
+  static const std::size_t CLASS_COUNT = 32; // classes of 16, 32, ... 512 bytes
+  static const std::size_t BLOCK_SIZE = 64 * 1024;
+
+  struct FreeNode {
+    FreeNode * next;
+  };
+
+  std::mutex mMutex;
+  FreeNode * mFree[CLASS_COUNT];
+  std::vector<std::unique_ptr<char[]>> mBlocks;
+  char * mCursor;
+  char * mEnd;
+
+};
+
+//! \brief Standard allocator over the PoolArena, for std::allocate_shared.
+template<typename T>
+class PoolAllocator {
+public:
+
+  typedef T value_type;
+
+  PoolAllocator() {}
+  template<typename U>
+  PoolAllocator(const PoolAllocator<U> &) {}
+
+  T * allocate(std::size_t n) {
+    return static_cast<T*>(PoolArena::getInstance().allocate(n * sizeof(T)));
+  }
+  void deallocate(T * pointer, std::size_t n) {
+    PoolArena::getInstance().deallocate(pointer, n * sizeof(T));
+  }
+
+};
+
+template<typename T, typename U>
+inline bool operator==(const PoolAllocator<T> &, const PoolAllocator<U> &) { return true; }
+template<typename T, typename U>
+inline bool operator!=(const PoolAllocator<T> &, const PoolAllocator<U> &) { return false; }
+
+//! Make a shared object whose memory, control block included, comes from
+//! the PoolArena in a single allocation.
+template<typename T, typename... Args>
+inline std::shared_ptr<T> makePooled(Args&&... args) {
+  return std::allocate_shared<T>(PoolAllocator<T>(), std::forward<Args>(args)...);
+}
+
+#endif
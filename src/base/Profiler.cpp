@@ -0,0 +1,169 @@
+#include "base/Profiler.hpp"
+#include <algorithm>
+#include <cstring>
+#include <iomanip>
+#include <sstream>
+
+namespace {
+
+// drawing colours of the sections, in Section order
+const SDL_Color SECTION_COLORS[Profiler::SECTION_COUNT] = {
+		{ 0x90, 0x90, 0x90, 0xFF }, { 0x40, 0xA0, 0xFF, 0xFF }, { 0xFF, 0xA0,
+				0x20, 0xFF }, { 0xE0, 0xE0, 0x40, 0xFF }, { 0xC0, 0x60, 0xFF,
+				0xFF }, { 0x40, 0xE0, 0x60, 0xFF }, { 0xFF, 0x50, 0x50, 0xFF } };
+
+const float GRAPH_MAX_MS = 50.0f;
+
+}
+
+const int Profiler::HISTORY;
+
+Profiler &Profiler::getInstance() {
+	static Profiler *instance = new Profiler();
+	return *instance;
+}
+
+void Profiler::startUp() {
+	mNext = 0;
+	mCount = 0;
+	std::memset(&mCurrent, 0, sizeof(mCurrent));
+	mMillisPerCount = 1000.0 / SDL_GetPerformanceFrequency();
+	mFrameStart = SDL_GetPerformanceCounter();
+}
+
+void Profiler::shutDown() {
+}
+
+void Profiler::addPhysicsStep(const b2Profile &profile) {
+	b2Profile &sum = mCurrent.physics;
+	sum.step += profile.step;
+	sum.collide += profile.collide;
+	sum.solve += profile.solve;
+	sum.solveInit += profile.solveInit;
+	sum.solveVelocity += profile.solveVelocity;
+	sum.solvePosition += profile.solvePosition;
+	sum.broadphase += profile.broadphase;
+	sum.solveTOI += profile.solveTOI;
+	mCurrent.steps++;
+}
+
+void Profiler::endFrame() {
+	Uint64 now = SDL_GetPerformanceCounter();
+	mCurrent.total = (now - mFrameStart) * mMillisPerCount;
+	mFrameStart = now;
+	mFrames[mNext] = mCurrent;
+	mNext = (mNext + 1) % HISTORY;
+	mCount = std::min(mCount + 1, HISTORY);
+	std::memset(&mCurrent, 0, sizeof(mCurrent));
+}
+
+const Profiler::Frame &Profiler::frame(int age) const {
+	return mFrames[(mNext - 1 - age + HISTORY) % HISTORY];
+}
+
+// Nearest rank; the sort is of at most HISTORY values, and only done when
+// the summary is refreshed
+float Profiler::percentile(int section, int percent) const {
+	if (mCount == 0) {
+		return 0.0f;
+	}
+	std::vector<float> times(mCount);
+	for (int age = 0; age < mCount; age++) {
+		const Frame &f = frame(age);
+		times[age] = section == SECTION_COUNT ? f.total : f.sections[section];
+	}
+	std::sort(times.begin(), times.end());
+	int rank = (mCount * percent + 99) / 100;
+	return times[std::max(rank, 1) - 1];
+}
+
+const char *Profiler::sectionName(int section) {
+	static const char *NAMES[SECTION_COUNT + 1] = { "events", "update",
+			"physics", "postStep", "removal", "render", "present", "frame" };
+	return NAMES[section];
+}
+
+std::vector<std::string> Profiler::summary() const {
+	std::vector<std::string> lines;
+	std::ostringstream line;
+	line << std::fixed << std::setprecision(2);
+	line << "ms over " << mCount << " frames: p50 / p99 / max";
+	lines.push_back(line.str());
+	// the whole frame first, then its sections
+	for (int i = 0; i <= SECTION_COUNT; i++) {
+		int section = (i + SECTION_COUNT) % (SECTION_COUNT + 1);
+		line.str("");
+		line << sectionName(section) << "  " << percentile(section, 50)
+				<< " / " << percentile(section, 99) << " / "
+				<< percentile(section, 100);
+		lines.push_back(line.str());
+	}
+
+	b2Profile mean;
+	std::memset(&mean, 0, sizeof(mean));
+	int steps = 0;
+	for (int age = 0; age < mCount; age++) {
+		const Frame &f = frame(age);
+		mean.collide += f.physics.collide;
+		mean.solve += f.physics.solve;
+		mean.broadphase += f.physics.broadphase;
+		mean.solveTOI += f.physics.solveTOI;
+		steps += f.steps;
+	}
+	if (steps > 0) {
+		line.str("");
+		line << "box2d per step: collide " << mean.collide / steps
+				<< "  solve " << mean.solve / steps << "  broadphase "
+				<< mean.broadphase / steps << "  toi " << mean.solveTOI / steps;
+		lines.push_back(line.str());
+	}
+	return lines;
+}
+
+// UPDATE and RENDER hold other sections, so each is drawn as only what is
+// left of it once those are taken out
+void Profiler::renderGraph(SDL_Renderer *renderer, const SDL_Rect &area) const {
+	SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
+	SDL_SetRenderDrawColor(renderer, 0x00, 0x00, 0x00, 0xB0);
+	SDL_RenderFillRect(renderer, &area);
+
+	const float pixelsPerMs = area.h / GRAPH_MAX_MS;
+	const int barWidth = std::max(1, area.w / HISTORY);
+	const int bottom = area.y + area.h;
+	for (int age = 0; age < mCount; age++) {
+		int x = area.x + area.w - (age + 1) * barWidth;
+		if (x < area.x) {
+			break;
+		}
+		const Frame &f = frame(age);
+		float y = bottom;
+		for (int section = 0; section < SECTION_COUNT; section++) {
+			float ms = f.sections[section];
+			if (section == UPDATE) {
+				ms -= f.sections[PHYSICS] + f.sections[POST_STEP]
+						+ f.sections[REMOVAL];
+			} else if (section == RENDER) {
+				ms -= f.sections[PRESENT];
+			}
+			float height = std::max(0.0f, ms) * pixelsPerMs;
+			const SDL_Color &c = SECTION_COLORS[section];
+			SDL_SetRenderDrawColor(renderer, c.r, c.g, c.b, c.a);
+			SDL_Rect bar = { x, int(y - height), barWidth, int(height + 0.5f) };
+			SDL_RenderFillRect(renderer, &bar);
+			y -= height;
+		}
+		// whatever the sections do not account for, such as sleeping
+		SDL_SetRenderDrawColor(renderer, 0x50, 0x50, 0x50, 0xFF);
+		SDL_Rect rest = { x, int(bottom - f.total * pixelsPerMs), barWidth,
+				std::max(0, int(y - (bottom - f.total * pixelsPerMs))) };
+		SDL_RenderFillRect(renderer, &rest);
+	}
+
+	SDL_SetRenderDrawColor(renderer, 0xFF, 0xFF, 0xFF, 0x80);
+	const float budgets[] = { 1000.0f / 60, 1000.0f / 30 };
+	for (float budget : budgets) {
+		int y = int(bottom - budget * pixelsPerMs);
+		SDL_RenderDrawLine(renderer, area.x, y, area.x + area.w - 1, y);
+	}
+	SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_NONE);
+}
@@ -0,0 +1,148 @@
+#ifndef BASE_PROFILER
+#define BASE_PROFILER
+
+#include <Box2D/Box2D.h>
+#include <SDL.h>
+#include <string>
+#include <vector>
+
+//! \brief Times the phases of each frame and keeps the last few seconds of
+//! them, for spotting spikes that an average frame rate hides.
+//!
+//! Code marks a phase with PROFILE_SCOPE(SECTION), which adds the time to
+//! the end of the enclosing block to the current frame's total for that
+//! section, and the loop closes each frame with PROFILE_END_FRAME().
+//! Sections nest: UPDATE includes the PHYSICS, POST_STEP and REMOVAL it
+//! runs, and RENDER includes PRESENT.  Box2D's own breakdown of each step
+//! is added with PROFILE_PHYSICS_STEP(world).
+//!
+//! The macros only do anything when ENGINE_PROFILER is defined (see the
+//! Makefile); otherwise they compile to nothing and the profiler is idle.
+class Profiler {
+private:
+
+	Profiler() = default; // Private Singleton
+	Profiler(Profiler const&) = delete; // Avoid copy constructor.
+	void operator=(Profiler const&) = delete; // Don't allow copy assignment.
+
+public:
+
+	//! The phases timed.
+	enum Section {
+		EVENTS, //!< Polling and handling SDL events.
+		UPDATE, //!< Level::update, all of it.
+		PHYSICS, //!< PhysicsManager::step.
+		POST_STEP, //!< Copying bodies back to objects.
+		REMOVAL, //!< Removing objects queued for removal.
+		RENDER, //!< Drawing and presenting the frame.
+		PRESENT, //!< SDL_RenderPresent, including any wait for vsync.
+		SECTION_COUNT
+	};
+
+	static const int HISTORY = 240; //!< Frames kept.
+
+	//! One finished frame, in milliseconds.
+	struct Frame {
+		float total; //!< From the end of the previous frame to the end of this one.
+		float sections[SECTION_COUNT];
+		int steps; //!< Physics steps run.
+		b2Profile physics; //!< Box2D's breakdown, summed over the frame's steps.
+	};
+
+	static Profiler &getInstance(); //!< Get the instance.
+
+	void startUp(); //!< Clear the history and start the first frame.
+	void shutDown();
+
+	//! Add time to a section of the current frame.
+	inline void add(Section section, Uint64 counts) {
+		mCurrent.sections[section] += counts * mMillisPerCount;
+	}
+
+	void addPhysicsStep(const b2Profile &profile); //!< Add a step's Box2D profile to the current frame.
+	void endFrame(); //!< Close the current frame and start the next.
+
+	inline int frameCount() const { return mCount; } //!< Finished frames held, up to HISTORY.
+
+	/**
+	 * A finished frame
+	 * @param int age: 0 for the last frame, 1 for the one before, and so on
+	 */
+	const Frame &frame(int age) const;
+
+	/**
+	 * A percentile of a section's times over the frames held
+	 * @param int section: a Section, or SECTION_COUNT for the whole frame
+	 * @param int percent: 0 to 100
+	 */
+	float percentile(int section, int percent) const;
+
+	static const char *sectionName(int section); //!< Short name of a section, or "frame".
+
+	/**
+	 * Lines of text summing up the frames held: p50, p99 and max of each
+	 * section and mean times of Box2D's parts of a step
+	 */
+	std::vector<std::string> summary() const;
+
+	inline bool overlayVisible() const { return mOverlay; }
+	inline void toggleOverlay() { mOverlay = !mOverlay; }
+
+	/**
+	 * Draw the frames held as a graph of stacked bars, newest on the right,
+	 * with lines at 60 and 30 frames per second
+	 * @param SDL_Renderer* renderer: where to draw
+	 * @param const SDL_Rect& area: the graph's bounds
+	 */
+	void renderGraph(SDL_Renderer *renderer, const SDL_Rect &area) const;
+
+private:
+
+	Frame mFrames[HISTORY];
+	int mNext = 0; // slot the next finished frame goes in
+	int mCount = 0;
+	Frame mCurrent;
+	Uint64 mFrameStart = 0;
+	double mMillisPerCount = 0.0;
+	bool mOverlay = false;
+
+};
+
+//! \brief Adds the time from its construction to its destruction to a
+//! section of the current frame; made by PROFILE_SCOPE.
+class ProfileScope {
+public:
+
+	inline ProfileScope(Profiler::Section section) :
+			mSection(section), mStart(SDL_GetPerformanceCounter()) {
+	}
+
+	inline ~ProfileScope() {
+		Profiler::getInstance().add(mSection,
+				SDL_GetPerformanceCounter() - mStart);
+	}
+
+private:
+
+	ProfileScope(const ProfileScope&) = delete;
+	void operator=(ProfileScope const&) = delete;
+
+	Profiler::Section mSection;
+	Uint64 mStart;
+
+};
+
+#define PROFILE_JOIN_(a, b) a##b
+#define PROFILE_JOIN(a, b) PROFILE_JOIN_(a, b)
+
+#ifdef ENGINE_PROFILER
+#define PROFILE_SCOPE(section) ProfileScope PROFILE_JOIN(profileScope, __LINE__)(Profiler::section)
+#define PROFILE_PHYSICS_STEP(world) Profiler::getInstance().addPhysicsStep((world)->GetProfile())
+#define PROFILE_END_FRAME() Profiler::getInstance().endFrame()
+#else
+#define PROFILE_SCOPE(section) ((void)0)
+#define PROFILE_PHYSICS_STEP(world) ((void)0)
+#define PROFILE_END_FRAME() ((void)0)
+#endif
+
+#endif
@@ -0,0 +1,52 @@
+#include "base/RectBatch.hpp"
+
+RectBatch::RectBatch() {
+}
+
+void RectBatch::begin(SDL_Renderer *renderer) {
+	mRenderer = renderer;
+	for (std::size_t i = 0; i < mUsed; i++) {
+		mGroups[i].rects.clear();
+	}
+	mUsed = 0;
+	mDrawCalls = 0;
+}
+
+// A linear search; there are rarely more than a few colours
+void RectBatch::fill(const SDL_Rect &rect, SDL_Color color) {
+	std::size_t i = 0;
+	while (i < mUsed
+			&& (mGroups[i].color.r != color.r || mGroups[i].color.g != color.g
+					|| mGroups[i].color.b != color.b
+					|| mGroups[i].color.a != color.a)) {
+		i++;
+	}
+	if (i == mUsed) {
+		if (mUsed == mGroups.size()) {
+			mGroups.push_back(Group());
+		}
+		mGroups[i].color = color;
+		mUsed++;
+	}
+	mGroups[i].rects.push_back(rect);
+}
+
+void RectBatch::flush() {
+	for (std::size_t i = 0; i < mUsed; i++) {
+		Group &group = mGroups[i];
+		if (mRenderer != nullptr) {
+			SDL_SetRenderDrawColor(mRenderer, group.color.r, group.color.g,
+					group.color.b, group.color.a);
+			SDL_RenderFillRects(mRenderer, group.rects.data(),
+					int(group.rects.size()));
+			mDrawCalls++;
+		}
+		group.rects.clear();
+	}
+	mUsed = 0;
+}
+
+void RectBatch::end() {
+	flush();
+	mRenderer = nullptr;
+}
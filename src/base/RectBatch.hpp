@@ -0,0 +1,53 @@
+#ifndef BASE_RECT_BATCH
+#define BASE_RECT_BATCH
+
+#include <SDL.h>
+#include <vector>
+
+//! \brief Collects the filled rectangles drawn in a frame, grouped by
+//! colour, and fills each group with one SDL_RenderFillRects call.
+//!
+//! Levels draw with only a few colours, so a level of hundreds of blocks
+//! takes a handful of calls.  Groups are filled in the order their colours
+//! were first used; within a frame, rectangles of one colour are drawn in
+//! the order they were queued.
+class RectBatch {
+public:
+
+	RectBatch();
+
+	void begin(SDL_Renderer *renderer); //!< Start collecting rectangles to draw with a renderer.
+
+	/**
+	 * Queue a filled rectangle; it is drawn by the next flush or end
+	 * @param const SDL_Rect& rect: the rectangle
+	 * @param SDL_Color color: its colour
+	 */
+	void fill(const SDL_Rect &rect, SDL_Color color);
+
+	void flush(); //!< Draw the rectangles queued so far.
+	void end(); //!< Draw what is left and stop collecting.
+
+	inline int drawCalls() const { return mDrawCalls; } //!< Calls made to the renderer since begin.
+
+private:
+
+	RectBatch(const RectBatch&) = delete;
+	void operator=(RectBatch const&) = delete;
+
+	//! The rectangles of one colour.
+	struct Group {
+		SDL_Color color;
+		std::vector<SDL_Rect> rects;
+	};
+
+	SDL_Renderer *mRenderer = nullptr;
+	// groups are kept, emptied, from frame to frame so their rects keep
+	// their room; mUsed of them hold rectangles
+	std::vector<Group> mGroups;
+	std::size_t mUsed = 0;
+	int mDrawCalls = 0;
+
+};
+
+#endif
@@ -1,5 +1,7 @@
 #include "base/RectRenderComponent.hpp"
 #include "base/GameObject.hpp"
+#include "base/Level.hpp"
+#include <cmath>
 
 RectRenderComponent::RectRenderComponent(GameObject & gameObject, Uint8 r, Uint8 g, Uint8 b):
   RenderComponent(gameObject),
@@ -13,7 +15,12 @@ void
 RectRenderComponent::render(SDL_Renderer * renderer) const
 {
   const GameObject & gameObject = getGameObject();
-  SDL_Rect fillRect = { int(gameObject.x()), int(gameObject.y()), int(gameObject.w()), int(gameObject.h()) };
-  SDL_SetRenderDrawColor(renderer, mR, mG, mB, 0xFF);
-  SDL_RenderFillRect(renderer, &fillRect);
+  const Camera & camera = gameObject.level().camera();
+  // floor rather than truncate, so objects left of or above the view's
+  // edge do not snap a pixel towards it
+  SDL_Rect fillRect = { int(std::floor(camera.toScreenX(gameObject.renderX()))),
+                        int(std::floor(camera.toScreenY(gameObject.renderY()))),
+                        int(gameObject.w()), int(gameObject.h()) };
+  SDL_Color color = { mR, mG, mB, 0xFF };
+  gameObject.level().drawList().fill(layer(), fillRect, color);
 }
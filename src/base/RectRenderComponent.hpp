@@ -4,7 +4,8 @@
 #include "base/RenderComponent.hpp"
 #include <SDL.h>
 
-//! \brief Handles rendering a game object as a simple rectangle.
+//! \brief Handles rendering a game object as a simple rectangle, queued
+//! in its level's draw list.
 class RectRenderComponent: public RenderComponent {
 public:
 
@@ -7,11 +7,11 @@ RemoveOnCollideComponent::RemoveOnCollideComponent(GameObject &gameObject,
 		int tag, Mix_Chunk *sound, int soundChannel) :
 		GenericComponent(gameObject), mTag(tag), collideSound(sound), channel(
 				soundChannel) {
+	setCollisionTags(tagBit(tag));
 }
 
-void RemoveOnCollideComponent::collision(Level &level,
-		std::shared_ptr<GameObject> obj) {
-	if (obj->tag() == mTag) {
+void RemoveOnCollideComponent::collision(Level &level, GameObject &obj) {
+	if (obj.tag() == mTag) {
 		level.removeObject(obj);
 		if (collideSound != nullptr) {
 			channel = Mix_PlayChannel(-1, collideSound, 0);
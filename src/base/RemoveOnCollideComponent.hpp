@@ -11,7 +11,7 @@ public:
 
   RemoveOnCollideComponent(GameObject & gameObject, int tag, Mix_Chunk* collideSound, int soundChannel);
   
-  virtual void collision(Level & level, std::shared_ptr<GameObject> obj) override;
+  virtual void collision(Level & level, GameObject & obj) override;
 
 private:
 
@@ -12,6 +12,19 @@ public:
 
   virtual void render(SDL_Renderer * renderer) const = 0; //!< Do the render.
 
+  /**
+   * Set the layer to draw in; higher layers are drawn over lower ones,
+   * and objects in one layer in no particular order
+   * @param Uint8 layer: the layer, 0 unless set
+   */
+  inline void setLayer(Uint8 layer) { mLayer = layer; }
+
+  inline Uint8 layer() const { return mLayer; } //!< Return the layer to draw in.
+
+private:
+
+  Uint8 mLayer = 0;
+
 };
 
 #endif
@@ -1,5 +1,6 @@
 #include "ResourceManager.hpp"
 #include "res_path.hpp"
+#include <cstring>
 #include <fstream>
 #include <iostream>
 
@@ -12,6 +13,35 @@
 // Initializing instance
 ResourceManager *ResourceManager::instance = 0;
 
+// The atlas is cached under a name no asset has
+namespace {
+const std::string SPRITE_ATLAS_KEY = "<sprite atlas>";
+
+// Reads a text file's lines; false if it cannot be opened
+bool readLines(const std::string &filePath, std::vector<std::string> &lines) {
+	std::ifstream inFile(filePath);
+	if (!inFile.is_open()) {
+		return false;
+	}
+	std::string line;
+	while (getline(inFile, line)) {
+		lines.push_back(line);
+	}
+	return true;
+}
+
+// Splits text held in memory into lines as getline would
+void splitLines(const char *text, std::size_t size, std::vector<std::string> &lines) {
+	std::size_t start = 0;
+	while (start < size) {
+		const char *end = static_cast<const char*>(std::memchr(text + start, '\n', size - start));
+		std::size_t length = end ? end - (text + start) : size - start;
+		lines.push_back(std::string(text + start, length));
+		start += length + 1;
+	}
+}
+}
+
 // Empty constructor
 ResourceManager::ResourceManager() {
 }
@@ -26,6 +56,12 @@ ResourceManager& ResourceManager::getInstance() {
 
 // Starts ResourceManager
 int ResourceManager::startUp() {
+	// loaded here, once, as IMG_Load would otherwise load the image
+	// libraries itself, unguarded, on each loader thread it runs on
+	int imageFormats = IMG_INIT_PNG | IMG_INIT_JPG;
+	if ((IMG_Init(imageFormats) & imageFormats) != imageFormats) {
+		SDL_Log("Failed to initialize image loading: %s", IMG_GetError());
+	}
 	std::cout << "Started" << std::endl;
 	return 0;
 }
@@ -35,6 +71,7 @@ int ResourceManager::shutDown() {
 	//Free the surface
 	SDL_FreeSurface(surface);
 	surface = NULL;
+	spriteAtlas.clear();
 	//Free the texture
 	//SDL_DestroyTexture(texture);
 	//sprites.clear();
@@ -42,37 +79,150 @@ int ResourceManager::shutDown() {
 	//Free the sound effects
 	Mix_FreeChunk(jumpEff);
 	Mix_FreeChunk(missEff);
+	Mix_FreeChunk(collectEff);
+	Mix_FreeChunk(collEff);
+	Mix_FreeChunk(goalEff);
 	jumpEff = NULL;
 	missEff = NULL;
+	collectEff = NULL;
+	collEff = NULL;
+	goalEff = NULL;
 
 	//Free the music
 	Mix_FreeMusic(bgm);
 	bgm = NULL;
+
+	//Close the fonts
+	for (auto &font : fonts) {
+		TTF_CloseFont(font.second);
+	}
+	fonts.clear();
+
+	//Unmap the archive, now nothing read from it is left
+	archive.close();
+
+	IMG_Quit();
+	return 0;
+}
+
+// Opens the archive the loads after this read from
+int ResourceManager::openArchive(std::string filename) {
+	std::string resPath = getResourcePath();
+	std::string filePath = resPath + filename;
+	if (!archive.open(filePath)) {
+		SDL_Log("No asset archive; loading files");
+		return 1;
+	}
+	SDL_Log("Opened asset archive");
 	return 0;
 }
 
+// The archive's copy of an asset, or NULL if it has none or the file was
+// changed after the archive was made, as the editor changes levels
+const AssetArchive::Entry *ResourceManager::findArchived(
+		const std::string &filename, const std::string &filePath) {
+	const AssetArchive::Entry *entry = archive.find(filename);
+	if (entry == NULL) {
+		return NULL;
+	}
+	if (archive.isOlderThan(filePath)) {
+		SDL_Log("%s is newer than the asset archive; loading the file",
+				filename.c_str());
+		return NULL;
+	}
+	return entry;
+}
+
+// A stream over a file kept whole in the archive, or NULL
+SDL_RWops *ResourceManager::openArchived(const AssetArchive::Entry *entry) {
+	if (entry == NULL || entry->kind != AssetArchive::RAW) {
+		return NULL;
+	}
+	return SDL_RWFromConstMem(archive.data(*entry), int(entry->size));
+}
+
+// Decoded pixels become a surface over the archive's memory, so neither
+// decoding nor copying is done; SDL leaves pixels it did not allocate alone
+SDL_Surface *ResourceManager::readSurface(const std::string &filename,
+		const std::string &filePath) {
+	const AssetArchive::Entry *entry = findArchived(filename, filePath);
+	if (entry != NULL && entry->kind == AssetArchive::IMAGE) {
+		Uint32 format = entry->params[3];
+		return SDL_CreateRGBSurfaceWithFormatFrom(archive.data(*entry),
+				entry->params[0], entry->params[1], SDL_BITSPERPIXEL(format),
+				entry->params[2], format);
+	}
+	SDL_RWops *archived = openArchived(entry);
+	if (archived != NULL) {
+		return IMG_Load_RW(archived, 1);
+	}
+	return IMG_Load(filePath.c_str());
+}
+
+// Samples already in the mixer's format are played from the archive as
+// they are; in any other format they could not be, so the file is read
+Mix_Chunk *ResourceManager::readEffect(const std::string &filename,
+		const std::string &filePath) {
+	const AssetArchive::Entry *entry = findArchived(filename, filePath);
+	if (entry != NULL && entry->kind == AssetArchive::SOUND) {
+		int frequency = 0;
+		Uint16 format = 0;
+		int channels = 0;
+		if (Mix_QuerySpec(&frequency, &format, &channels)
+				&& Uint32(frequency) == entry->params[0]
+				&& format == entry->params[1]
+				&& Uint32(channels) == entry->params[2]
+				&& entry->size <= SDL_MAX_UINT32) {
+			return Mix_QuickLoad_RAW(archive.data(*entry), entry->size);
+		}
+		return Mix_LoadWAV(filePath.c_str());
+	}
+	SDL_RWops *archived = openArchived(entry);
+	if (archived != NULL) {
+		return Mix_LoadWAV_RW(archived, 1);
+	}
+	return Mix_LoadWAV(filePath.c_str());
+}
+
+// Music streams as it plays, from the archive's memory when it is there
+Mix_Music *ResourceManager::readMusic(const std::string &filename,
+		const std::string &filePath) {
+	SDL_RWops *archived = openArchived(findArchived(filename, filePath));
+	if (archived != NULL) {
+		return Mix_LoadMUS_RW(archived, 1);
+	}
+	return Mix_LoadMUS(filePath.c_str());
+}
+
+bool ResourceManager::readText(const std::string &filename,
+		const std::string &filePath, std::vector<std::string> &lines) {
+	const AssetArchive::Entry *entry = findArchived(filename, filePath);
+	if (entry != NULL && entry->kind == AssetArchive::RAW) {
+		splitLines(reinterpret_cast<const char*>(archive.data(*entry)),
+				entry->size, lines);
+		return true;
+	}
+	return readLines(filePath, lines);
+}
+
 // Loads in text to display from text file
 int ResourceManager::loadText(std::string filename) {
 	std::string resPath = getResourcePath();
 	std::string filePath = resPath + filename;
-	std::ifstream inFile(filePath);
-	std::string line;
+	std::vector < std::string > lines;
 
-	if (inFile.is_open()) {
+	if (readText(filename, filePath, lines)) {
 		SDL_Log("Loaded text");
-		while (getline(inFile, line)) {
-			if (filename.compare("Text/russian.txt") == 0) {
-				russianText.push_back(line);
-			} else if (filename.compare("Text/english.txt") == 0) {
-				englishText.push_back(line);
-			}
+		if (filename.compare("Text/russian.txt") == 0) {
+			russianText.insert(russianText.end(), lines.begin(), lines.end());
+		} else if (filename.compare("Text/english.txt") == 0) {
+			englishText.insert(englishText.end(), lines.begin(), lines.end());
 		}
 	} else {
 		SDL_Log("Failed to open text");
 		return 1;
 	}
 
-	inFile.close();
 	return 0;
 }
 
@@ -82,19 +232,13 @@ int ResourceManager::loadLevel(std::string filename) {
 	std::string filePath = resPath + filename;
 	std::vector < std::string > level;
 
-	std::ifstream inFile(filePath);
-	std::string line;
-	if (inFile.is_open()) {
+	if (readText(filename, filePath, level)) {
 		SDL_Log("Loaded level");
-		while (getline(inFile, line)) {
-			level.push_back(line);
-		}
 	} else {
 		SDL_Log("Failed to open level");
 		return 1;
 	}
 
-	inFile.close();
 	levelVector.push_back(level);
 	return 0;
 }
@@ -118,7 +262,7 @@ int ResourceManager::loadSurface(std::string filename) {
 	//Load image at specified path
 	std::string resPath = getResourcePath();
 	std::string filePath = resPath + filename;
-	SDL_Surface *loadedSurface = IMG_Load(filePath.c_str());
+	SDL_Surface *loadedSurface = readSurface(filename, filePath);
 	if (loadedSurface == NULL) {
 		SDL_Log("Failed to load image");
 		return 1;
@@ -126,14 +270,121 @@ int ResourceManager::loadSurface(std::string filename) {
 		SDL_Log("Loaded image");
 	}
 	surfaces.push_back(loadedSurface);
+	surfaceFiles[filename] = loadedSurface;
 	return 0;
 }
 
+// Packs the loaded surfaces into one atlas
+int ResourceManager::packSprites() {
+	if (!spriteAtlas.build(surfaces)) {
+		SDL_Log("Failed to pack sprites");
+		return 1;
+	}
+	return 0;
+}
+
+CachedTexture::~CachedTexture() {
+	SDL_DestroyTexture(texture);
+	if (cached) {
+		ResourceManager::getInstance().textures.erase(
+				std::make_pair(renderer, key));
+	}
+}
+
+// A handle is always returned, so holders need not check for one; a
+// failed texture is not cached, so it is tried again next time
+TextureHandle ResourceManager::cachedTexture(SDL_Renderer *renderer,
+		const std::string &key, SDL_Surface *surface) {
+	std::pair<SDL_Renderer*, std::string> cacheKey(renderer, key);
+	auto found = textures.find(cacheKey);
+	if (found != textures.end()) {
+		TextureHandle handle = found->second.lock();
+		if (handle) {
+			return handle;
+		}
+	}
+	TextureHandle handle = std::make_shared<CachedTexture>();
+	handle->renderer = renderer;
+	handle->key = key;
+	if (surface != NULL) {
+		handle->texture = createTexture(renderer, surface);
+	}
+	if (renderer != NULL && handle->texture == NULL) {
+		handle->cached = false;
+		return handle;
+	}
+	textures[cacheKey] = handle;
+	return handle;
+}
+
+TextureHandle ResourceManager::getTexture(SDL_Renderer *renderer,
+		std::string filename) {
+	auto found = surfaceFiles.find(filename);
+	return cachedTexture(renderer, filename,
+			found != surfaceFiles.end() ? found->second : NULL);
+}
+
+TextureHandle ResourceManager::getSpriteAtlasTexture(SDL_Renderer *renderer) {
+	return cachedTexture(renderer, SPRITE_ATLAS_KEY, spriteAtlas.surface());
+}
+
+void ResourceManager::releaseTextures(SDL_Renderer *renderer) {
+	for (auto i = textures.begin(); i != textures.end();) {
+		if (i->first.first != renderer) {
+			++i;
+			continue;
+		}
+		TextureHandle handle = i->second.lock();
+		if (handle) {
+			SDL_DestroyTexture(handle->texture);
+			handle->texture = NULL;
+			handle->cached = false;
+		}
+		i = textures.erase(i);
+	}
+}
+
+// Makes a texture for a renderer; headless runs have none and need none
+SDL_Texture* ResourceManager::createTexture(SDL_Renderer *renderer,
+		SDL_Surface *surface) {
+	if (renderer == NULL) {
+		return NULL;
+	}
+	SDL_Texture *texture = SDL_CreateTextureFromSurface(renderer, surface);
+	if (texture == NULL) {
+		SDL_Log("Failed to create texture");
+	} else {
+		SDL_Log("Loaded texture");
+	}
+	return texture;
+}
+
+// Opens each font and size once; the HUD asks for its font every frame
+TTF_Font* ResourceManager::loadFont(std::string filename, int size) {
+	std::pair<std::string, int> key(filename, size);
+	auto found = fonts.find(key);
+	if (found != fonts.end()) {
+		return found->second;
+	}
+	std::string resPath = getResourcePath();
+	std::string filePath = resPath + filename;
+	SDL_RWops *archived = openArchived(findArchived(filename, filePath));
+	TTF_Font *font = archived != NULL ? TTF_OpenFontRW(archived, 1, size)
+			: TTF_OpenFont(filePath.c_str(), size);
+	if (font == NULL) {
+		SDL_Log("Failed to load font");
+		return NULL;
+	}
+	SDL_Log("Loaded font");
+	fonts[key] = font;
+	return font;
+}
+
 //Load BGM
 int ResourceManager::loadBGM(std::string filename) {
 	std::string resPath = getResourcePath();
 	std::string filePath = resPath + filename;
-	bgm = Mix_LoadMUS(filePath.c_str());
+	bgm = readMusic(filename, filePath);
 	if (bgm == NULL) {
 		SDL_Log("Failed to allocate background music");
 		return 1;
@@ -147,7 +398,7 @@ int ResourceManager::loadBGM(std::string filename) {
 int ResourceManager::loadJumpEffect(std::string filename) {
 	std::string resPath = getResourcePath();
 	std::string filePath = resPath + filename;
-	jumpEff = Mix_LoadWAV(filePath.c_str());
+	jumpEff = readEffect(filename, filePath);
 	if (jumpEff == NULL) {
 		SDL_Log("Failed to allocate jump sound effect");
 		return 1;
@@ -160,7 +411,7 @@ int ResourceManager::loadJumpEffect(std::string filename) {
 int ResourceManager::loadMissEffect(std::string filename) {
 	std::string resPath = getResourcePath();
 	std::string filePath = resPath + filename;
-	missEff = Mix_LoadWAV(filePath.c_str());
+	missEff = readEffect(filename, filePath);
 	if (missEff == NULL) {
 		SDL_Log("Failed to allocate background music");
 		return 1;
@@ -173,7 +424,7 @@ int ResourceManager::loadMissEffect(std::string filename) {
 int ResourceManager::loadCollectEffect(std::string filename) {
 	std::string resPath = getResourcePath();
 	std::string filePath = resPath + filename;
-	collectEff = Mix_LoadWAV(filePath.c_str());
+	collectEff = readEffect(filename, filePath);
 	if (collectEff == NULL) {
 		SDL_Log("Failed to allocate collectible sound effect");
 		return 1;
@@ -186,7 +437,7 @@ int ResourceManager::loadCollectEffect(std::string filename) {
 int ResourceManager::loadCollisionEffect(std::string filename) {
 	std::string resPath = getResourcePath();
 	std::string filePath = resPath + filename;
-	collEff = Mix_LoadWAV(filePath.c_str());
+	collEff = readEffect(filename, filePath);
 	if (collEff == NULL) {
 		SDL_Log("Failed to allocate background music");
 		return 1;
@@ -199,7 +450,7 @@ int ResourceManager::loadCollisionEffect(std::string filename) {
 int ResourceManager::loadGoalEffect(std::string filename) {
 	std::string resPath = getResourcePath();
 	std::string filePath = resPath + filename;
-	goalEff = Mix_LoadWAV(filePath.c_str());
+	goalEff = readEffect(filename, filePath);
 	if (goalEff == NULL) {
 		SDL_Log("Failed to allocate collectible sound effect");
 		return 1;
@@ -213,3 +464,108 @@ std::vector<SDL_Surface*> ResourceManager::getSurfaces() {
 	return surfaces;
 }
 
+
+std::shared_future<int> ResourceManager::loadSurfaceAsync(std::string filename) {
+	return startLoad(PendingLoad::SURFACE, filename);
+}
+
+std::shared_future<int> ResourceManager::loadLevelAsync(std::string filename) {
+	return startLoad(PendingLoad::LEVEL, filename);
+}
+
+std::shared_future<int> ResourceManager::loadBGMAsync(std::string filename) {
+	return startLoad(PendingLoad::BGM, filename);
+}
+
+std::shared_future<int> ResourceManager::loadEffectAsync(std::string filename,
+		Mix_Chunk *ResourceManager::*effect) {
+	return startLoad(PendingLoad::EFFECT, filename, effect);
+}
+
+// The loader thread reads the file, or the archive, into the pending load
+// and writes nothing else; the ResourceManager itself is only changed by
+// finishLoading, on the thread that started the loads
+std::shared_future<int> ResourceManager::startLoad(PendingLoad::Kind kind,
+		const std::string &filename, Mix_Chunk *ResourceManager::*effect) {
+	std::unique_ptr<PendingLoad> pending(new PendingLoad());
+	pending->kind = kind;
+	pending->filename = filename;
+	pending->effect = effect;
+	std::shared_future<int> future = pending->result.get_future().share();
+	PendingLoad *load = pending.get();
+	pendingLoads.push_back(std::move(pending));
+
+	std::string filePath = getResourcePath() + filename;
+	loader.post([this, load, filePath]() {
+		bool loaded = false;
+		switch (load->kind) {
+		case PendingLoad::SURFACE:
+			load->surface = readSurface(load->filename, filePath);
+			loaded = load->surface != NULL;
+			break;
+		case PendingLoad::LEVEL:
+			loaded = readText(load->filename, filePath, load->level);
+			break;
+		case PendingLoad::BGM:
+			load->music = readMusic(load->filename, filePath);
+			loaded = load->music != NULL;
+			break;
+		case PendingLoad::EFFECT:
+			load->chunk = readEffect(load->filename, filePath);
+			loaded = load->chunk != NULL;
+			break;
+		}
+		if (!loaded) {
+			SDL_Log("Failed to load %s", load->filename.c_str());
+		}
+		load->status = loaded ? 0 : 1;
+		load->result.set_value(load->status);
+	});
+	return future;
+}
+
+float ResourceManager::loadingProgress() {
+	std::size_t posted = loader.posted();
+	return posted == 0 ? 1.0f : float(loader.finished()) / posted;
+}
+
+int ResourceManager::finishLoading() {
+	std::size_t total = loader.posted();
+	std::size_t finished = 0;
+	while (finished < total) {
+		finished = loader.waitForMore(finished);
+		SDL_Log("Loaded %d of %d assets", int(finished), int(total));
+	}
+	loader.wait();
+
+	int failed = 0;
+	for (auto &pending : pendingLoads) {
+		switch (pending->kind) {
+		case PendingLoad::SURFACE:
+			if (pending->surface != NULL) {
+				surfaces.push_back(pending->surface);
+				surfaceFiles[pending->filename] = pending->surface;
+			}
+			break;
+		case PendingLoad::LEVEL:
+			// a level that failed still takes its place, as an empty one
+			levelVector.push_back(pending->level);
+			break;
+		case PendingLoad::BGM:
+			if (pending->music != NULL) {
+				Mix_FreeMusic(bgm);
+				bgm = pending->music;
+			}
+			break;
+		case PendingLoad::EFFECT:
+			if (pending->chunk != NULL) {
+				Mix_FreeChunk(this->*pending->effect);
+				this->*pending->effect = pending->chunk;
+			}
+			break;
+		}
+		failed += pending->status;
+	}
+	pendingLoads.clear();
+	return failed;
+}
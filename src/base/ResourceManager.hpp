@@ -3,9 +3,31 @@
 #include <SDL.h>
 #include <SDL_image.h>
 #include <SDL_mixer.h>
+#include <SDL_ttf.h>
+#include "base/AssetArchive.hpp"
+#include "base/AssetLoader.hpp"
+#include "base/SpriteAtlas.hpp"
+#include <future>
 #include <string>
 #include <map>
+#include <memory>
 #include <vector>
+
+/**
+ * A texture in the ResourceManager's cache, shared by every handle to it.
+ * It is destroyed when the last handle goes, or when its renderer is
+ * released, after which texture is NULL.
+ */
+struct CachedTexture {
+	SDL_Texture *texture = NULL;
+	SDL_Renderer *renderer = NULL;
+	std::string key;
+	bool cached = true; // still listed in the cache
+
+	~CachedTexture();
+};
+
+typedef std::shared_ptr<CachedTexture> TextureHandle;
 /**
  * A class for managing game resources.  Allows access to resources
  * and makes sure there is only one copy of each resource loaded at a
@@ -23,6 +45,57 @@ private:
 	// ... // perhaps other private members
 	static ResourceManager *instance;
 
+	// fonts opened so far, by file name and point size
+	std::map<std::pair<std::string, int>, TTF_Font*> fonts;
+
+	// surfaces loaded so far, by file name
+	std::map<std::string, SDL_Surface*> surfaceFiles;
+
+	// textures made so far, by renderer and asset; the handles own them
+	std::map<std::pair<SDL_Renderer*, std::string>, std::weak_ptr<CachedTexture>> textures;
+	friend struct CachedTexture;
+
+	TextureHandle cachedTexture(SDL_Renderer *renderer, const std::string &key,
+			SDL_Surface *surface);
+
+	// an asynchronous load; a loader thread fills in what it read, and
+	// finishLoading stores it
+	struct PendingLoad {
+		enum Kind { SURFACE, LEVEL, BGM, EFFECT } kind;
+		std::string filename;
+		Mix_Chunk *ResourceManager::*effect; // where an EFFECT goes
+		SDL_Surface *surface = NULL;
+		std::vector<std::string> level;
+		Mix_Music *music = NULL;
+		Mix_Chunk *chunk = NULL;
+		int status = 1; // what the load call would have returned
+		std::promise<int> result;
+	};
+
+	// opened by openArchive; what it holds is read from it, not the files.
+	// Declared before the loader, whose threads may still be reading it.
+	AssetArchive archive;
+
+	AssetLoader loader;
+	// in the order the loads were started, which is the order they are stored in
+	std::vector<std::unique_ptr<PendingLoad>> pendingLoads;
+
+	std::shared_future<int> startLoad(PendingLoad::Kind kind,
+			const std::string &filename,
+			Mix_Chunk *ResourceManager::*effect = NULL);
+
+	// Each reads an asset from the archive if it is there and its file
+	// has not changed since, and from its file if not.  They only read the
+	// archive, so loader threads call them too.
+	const AssetArchive::Entry *findArchived(const std::string &filename,
+			const std::string &filePath);
+	SDL_RWops *openArchived(const AssetArchive::Entry *entry);
+	SDL_Surface *readSurface(const std::string &filename, const std::string &filePath);
+	Mix_Chunk *readEffect(const std::string &filename, const std::string &filePath);
+	Mix_Music *readMusic(const std::string &filename, const std::string &filePath);
+	bool readText(const std::string &filename, const std::string &filePath,
+			std::vector<std::string> &lines);
+
 public:
 
 	/**
@@ -33,39 +106,44 @@ public:
 	std::vector<std::string> russianText;
 	std::vector<std::string> englishText;
 	std::vector<SDL_Surface*> surfaces;
+
+	/**
+	 * The loaded surfaces packed together by packSprites
+	 */
+	SpriteAtlas spriteAtlas;
 	int loadText(std::string filename);
 
 	/**
 	 * An allocated surface that holds the different frames an animation
 	 */
-	SDL_Surface *surface;
+	SDL_Surface *surface = NULL;
 
 	/**
 	 * The music to be played
 	 */
-	Mix_Music *bgm;
+	Mix_Music *bgm = NULL;
 
 	/**
 	 * Jump sound effect
 	 */
-	Mix_Chunk *jumpEff;
+	Mix_Chunk *jumpEff = NULL;
 	/**
 	 * Ball loss sound effect
 	 */
-	Mix_Chunk *missEff;
+	Mix_Chunk *missEff = NULL;
 	/**
 	 * Collect item sound effect
 	 */
-	Mix_Chunk *collectEff;
+	Mix_Chunk *collectEff = NULL;
 	/**
 	 * Collision sound effect
 	 */
-	Mix_Chunk *collEff;
+	Mix_Chunk *collEff = NULL;
 
 	/**
 	 * Reach goal sound effect
 	 */
-	Mix_Chunk *goalEff;
+	Mix_Chunk *goalEff = NULL;
 	/**
 	 * Stores level layout from files in a vector
 	 */
@@ -73,7 +151,8 @@ public:
 
 	/**
 	 *  'equivalent' to our constructor
-	 *  A method that acts as a constructor. It does nothing as of right now.
+	 *  A method that acts as a constructor.  Initializes image loading;
+	 *  call it before loading anything.
 	 */
 	int startUp();
 
@@ -83,6 +162,16 @@ public:
 	 */
 	int shutDown();
 
+	/**
+	 * Maps an archive made by the packer, so later loads read what it
+	 * holds from it instead of from the files; anything not in it is
+	 * still read from its file.  Images and sounds in it are used where
+	 * they lie, without decoding, so it stays open until shutDown.
+	 * Returns 1, and the files are used, if it cannot be opened.
+	 * @param std::string filename: the name of the archive.
+	 */
+	int openArchive(std::string filename);
+
 	/**
 	 * Takes in the name of a file and loads it into a texture
 	 * @param std::string filename: the name of the file.
@@ -140,6 +229,96 @@ public:
 
 	std::vector<SDL_Surface*> getSurfaces();
 
+	/**
+	 * Starts loading an image, as loadSurface does, on a loader thread and
+	 * returns at once.  The future holds what loadSurface would have
+	 * returned once the file is read; the surface is added to surfaces by
+	 * finishLoading, in the order the loads were started.
+	 * @param std::string filename: the name of the file.
+	 */
+	std::shared_future<int> loadSurfaceAsync(std::string filename);
+
+	/**
+	 * Starts loading a level, as loadLevel does; it is added to levelVector
+	 * by finishLoading, in the order the loads were started
+	 * @param std::string filename: the name of the file.
+	 */
+	std::shared_future<int> loadLevelAsync(std::string filename);
+
+	/**
+	 * Starts loading the music, as loadBGM does; finishLoading sets bgm
+	 * @param std::string filename: the name of the file.
+	 */
+	std::shared_future<int> loadBGMAsync(std::string filename);
+
+	/**
+	 * Starts loading a sound effect; finishLoading stores it in the member
+	 * given, e.g. &ResourceManager::jumpEff
+	 * @param std::string filename: the name of the file.
+	 * @param Mix_Chunk* ResourceManager::* effect: where to store it.
+	 */
+	std::shared_future<int> loadEffectAsync(std::string filename,
+			Mix_Chunk *ResourceManager::*effect);
+
+	/**
+	 * Returns the fraction of the loads started since the last
+	 * finishLoading that are done, or 1 if none were started
+	 */
+	float loadingProgress();
+
+	/**
+	 * Waits for the loads started so far, logging progress as they finish,
+	 * and stores what they read.  Call before using any of it and before
+	 * loading anything the usual way.  Returns the number that failed.
+	 */
+	int finishLoading();
+
+	/**
+	 * Packs every surface loaded so far into spriteAtlas, so their sprites
+	 * share one texture.  Call once the sprites are loaded.
+	 */
+	int packSprites();
+
+	/**
+	 * Opens a font at a size the first time it is asked for and returns
+	 * the same one after that; shutDown closes it.  Returns NULL if the
+	 * font cannot be opened.
+	 * @param std::string filename: the name of the file.
+	 * @param int size: the point size.
+	 */
+	TTF_Font* loadFont(std::string filename, int size);
+
+	/**
+	 * Gets the texture of a surface loaded with loadSurface, made the first
+	 * time it is asked for with this renderer and shared after that.  The
+	 * handle's texture is NULL when there is no renderer, as in a headless
+	 * run, or the file was not loaded.
+	 * @param SDL_Renderer* renderer: the renderer, or NULL
+	 * @param std::string filename: the name the surface was loaded by.
+	 */
+	TextureHandle getTexture(SDL_Renderer *renderer, std::string filename);
+
+	/**
+	 * Gets the texture of spriteAtlas, shared like getTexture's
+	 * @param SDL_Renderer* renderer: the renderer, or NULL
+	 */
+	TextureHandle getSpriteAtlasTexture(SDL_Renderer *renderer);
+
+	/**
+	 * Destroys the cached textures of a renderer about to be destroyed;
+	 * handles still held to them are left with a NULL texture
+	 * @param SDL_Renderer* renderer: the renderer
+	 */
+	void releaseTextures(SDL_Renderer *renderer);
+
+	/**
+	 * Makes a texture from a loaded surface.  Returns NULL, without
+	 * logging a failure, when there is no renderer, as in a headless run.
+	 * @param SDL_Renderer* renderer: the renderer, or NULL
+	 * @param SDL_Surface* surface: the surface to copy
+	 */
+	SDL_Texture* createTexture(SDL_Renderer *renderer, SDL_Surface *surface);
+
 };
 
 #endif
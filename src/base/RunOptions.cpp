@@ -0,0 +1,29 @@
+#include "base/RunOptions.hpp"
+#include <cstdlib>
+#include <cstring>
+
+RunOptions RunOptions::parse(int argc, char **argv) {
+	RunOptions options;
+	for (int i = 1; i < argc; i++) {
+		bool hasValue = i + 1 < argc;
+		if (std::strcmp(argv[i], "--headless") == 0) {
+			options.headless = true;
+		} else if (std::strcmp(argv[i], "--ticks") == 0 && hasValue) {
+			options.ticks = std::atol(argv[++i]);
+		} else if (std::strcmp(argv[i], "--speed") == 0 && hasValue) {
+			options.speed = std::atof(argv[++i]);
+		} else if (std::strcmp(argv[i], "--script") == 0 && hasValue) {
+			options.script = argv[++i];
+		} else if (std::strcmp(argv[i], "--record") == 0 && hasValue) {
+			options.record = argv[++i];
+		} else if (std::strcmp(argv[i], "--replay") == 0 && hasValue) {
+			options.replay = argv[++i];
+			options.headless = true;
+		} else if (std::strcmp(argv[i], "--pipelined") == 0) {
+			options.pipelined = true;
+		} else if (std::strcmp(argv[i], "--check-allocs") == 0 && hasValue) {
+			options.checkAllocs = std::atol(argv[++i]);
+		}
+	}
+	return options;
+}
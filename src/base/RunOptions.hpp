@@ -0,0 +1,23 @@
+#ifndef BASE_RUN_OPTIONS
+#define BASE_RUN_OPTIONS
+
+#include <string>
+
+//! \brief How a game was asked to run on the command line.
+struct RunOptions {
+	bool headless = false; //!< --headless: run with no window; see HeadlessProgram.
+	long ticks = 3600; //!< --ticks N: simulation steps for a headless run.
+	double speed = 0.0; //!< --speed X: multiple of real time, or 0 for as fast as possible.
+	std::string script; //!< --script FILE: scripted input for a headless run.
+	std::string record; //!< --record FILE: record the run's input; see InputRecording.
+	std::string replay; //!< --replay FILE: replay recorded input; implies --headless.
+	bool pipelined = false; //!< --pipelined: simulate the next frame while drawing this one; see SDLGraphicsProgram::setPipelined.
+	long checkAllocs = -1; //!< --check-allocs N: fail a headless run if any tick N or more into a level allocates.
+
+	/**
+	 * Read the options from a program's arguments, ignoring any others
+	 */
+	static RunOptions parse(int argc, char **argv);
+};
+
+#endif
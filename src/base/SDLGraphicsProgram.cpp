@@ -4,17 +4,23 @@
 // Please do not redistribute without asking permission.
 
 #include "SDLGraphicsProgram.hpp"
+#include "AllocationTracker.hpp"
 #include "InputManager.hpp"
+#include "JobSystem.hpp"
+#include "OwnershipStats.hpp"
 #include "PhysicsManager.hpp"
+#include "Profiler.hpp"
 #include "ResourceManager.hpp"
+#include "SimulationClock.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
 #include <iostream>
 #include <sstream>
 #include <time.h>
 
 int game;
 
-const int SCREEN_FPS = 60;
-const int SCREEN_TICKS_PER_FRAME = 1000 / SCREEN_FPS;
 float avgFPS;
 
 LTimer fpsTimer;
@@ -31,8 +37,9 @@ SDLGraphicsProgram::SDLGraphicsProgram(
 		mLevel(levels[0]) {
 	gameLevels = levels;
 	game = GAME_ID;
-	// Initialize random number generation.
-	srand(time(nullptr));
+	// Initialize random number generation; the seed goes in any recording
+	mSeed = static_cast<std::uint32_t>(time(nullptr));
+	srand(mSeed);
 	// Initialization flag
 	bool success = true;
 	// String to hold any errors that occur.
@@ -58,7 +65,8 @@ SDLGraphicsProgram::SDLGraphicsProgram(
 		}
 
 		//Create a Renderer to draw on
-		mRenderer = SDL_CreateRenderer(mWindow, -1, SDL_RENDERER_ACCELERATED);
+		mRenderer = SDL_CreateRenderer(mWindow, -1,
+				SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC);
 		// Check if Renderer did not create.
 		if (mRenderer == nullptr) {
 			errorStream << "Renderer could not be created! SDL Error: "
@@ -66,15 +74,34 @@ SDLGraphicsProgram::SDLGraphicsProgram(
 			success = false;
 		}
 	}
+	// software renderers and some drivers do not honour vsync; sleep instead
+	SDL_RendererInfo rendererInfo;
+	if (mRenderer == nullptr
+			|| SDL_GetRendererInfo(mRenderer, &rendererInfo) != 0
+			|| (rendererInfo.flags & SDL_RENDERER_PRESENTVSYNC) == 0) {
+		mFrameRateCap = FALLBACK_FRAME_RATE_CAP;
+	}
 
 	if (TTF_Init() != 0) {
 		logSDLError(std::cout, "TTF_Init");
 		SDL_Quit();
 		success = false;
 	}
+	// each font is opened once and its glyphs kept in an atlas; without
+	// SDL_ttf they draw nothing
+	mHudFont.reset(new TextRenderer(mRenderer, "Fonts/712_serif.ttf", 36));
+	mHud.reset(new TextRenderer::Label(*mHudFont));
+#ifdef ENGINE_PROFILER
+	mProfilerFont.reset(new TextRenderer(mRenderer, "Fonts/712_serif.ttf", 16));
+#endif
 
 	InputManager::getInstance().startUp();
 	PhysicsManager::getInstance().startUp();
+	SimulationClock::getInstance().startUp();
+	Profiler::getInstance().startUp();
+	setTickRate(DEFAULT_TICK_RATE);
+	// ENGINE_THREADS sets the thread count; the default of 1 runs inline
+	JobSystem::getInstance().startUp();
 	// If initialization did not work, then print out a list of errors in the constructor.
 	if (!success) {
 		errorStream << "Failed to initialize!\n";
@@ -87,9 +114,25 @@ SDLGraphicsProgram::SDLGraphicsProgram(
 
 // Proper shutdown and destroy initialized objects
 SDLGraphicsProgram::~SDLGraphicsProgram() {
+	mRecording.finish();
+	JobSystem::getInstance().shutDown();
+	Profiler::getInstance().shutDown();
+	SimulationClock::getInstance().shutDown();
 	PhysicsManager::getInstance().shutDown();
 	InputManager::getInstance().shutDown();
 
+#ifdef ENGINE_PROFILER
+	mProfilerText.clear();
+	mProfilerFont.reset();
+#endif
+	mHud.reset();
+	mHudFont.reset();
+	// the levels may outlive the renderer; their textures may not
+	for (auto &level : gameLevels) {
+		level->releaseTextures();
+	}
+	ResourceManager::getInstance().releaseTextures(mRenderer);
+
 	// Destroy Renderer
 	SDL_DestroyRenderer(mRenderer);
 	mRenderer = nullptr;
@@ -104,9 +147,54 @@ SDLGraphicsProgram::~SDLGraphicsProgram() {
 
 // Update OpenGL
 void SDLGraphicsProgram::update() {
+	PROFILE_SCOPE(UPDATE);
 	mLevel->update();
 }
 
+void SDLGraphicsProgram::setTickRate(int stepsPerSecond) {
+	if (stepsPerSecond <= 0) {
+		SDL_Log("Ignored tick rate %d; it must be positive", stepsPerSecond);
+		return;
+	}
+	PhysicsManager::getInstance().setTimeStep(1.0f / stepsPerSecond);
+}
+
+void SDLGraphicsProgram::setMaxStepsPerFrame(int steps) {
+	mMaxStepsPerFrame = steps;
+}
+
+void SDLGraphicsProgram::setFrameRateCap(int framesPerSecond) {
+	mFrameRateCap = framesPerSecond;
+}
+
+void SDLGraphicsProgram::setPipelined(bool pipelined) {
+	mPipelined = pipelined;
+}
+
+// Key presses are cleared once a step has seen them, so none are lost on
+// a frame that runs no step or seen twice on one that runs several
+void SDLGraphicsProgram::simulate() {
+	for (int step = 0; step < mSteps; step++) {
+		mRecording.beginStep();
+		update();
+		InputManager::getInstance().resetForFrame();
+	}
+	// recorded part way from the last step to the next
+	mLevel->setInterpolation(mInterpolation);
+	mLevel->record();
+}
+
+bool SDLGraphicsProgram::recordInput(const std::string &filename) {
+	return mRecording.startRecording(filename, mSeed,
+			PhysicsManager::getInstance().timeStep());
+}
+
+// Initialize the current level; a replay starts the same level on the same step
+void SDLGraphicsProgram::startLevel() {
+	mLevel->initialize(mRenderer);
+	mRecording.levelStarted(mLevelNum);
+}
+
 // Log an error
 void SDLGraphicsProgram::logSDLError(std::ostream &os, const std::string &msg) {
 	os << msg << " error: " << SDL_GetError() << std::endl;
@@ -121,6 +209,8 @@ void SDLGraphicsProgram::loadText() {
 // Render
 // The render function gets called once per loop
 void SDLGraphicsProgram::render() {
+	PROFILE_SCOPE(RENDER);
+	ALLOC_SCOPE(RENDER);
 	if (game == 1) {
 		SDL_SetRenderDrawColor(mRenderer, 0x73, 0xCE, 0xD8, 0xFF);
 	} else if (game == 2) {
@@ -130,87 +220,84 @@ void SDLGraphicsProgram::render() {
 	}
 	SDL_RenderClear(mRenderer);
 
-	mLevel->render(mRenderer);
-	std::stringstream timeText;
-	timeText.str("");
-	timeText << "FPS: " << avgFPS;
-	std::stringstream scoreText;
-	scoreText.str("");
-	scoreText << textVector[0] << mLevel->getScore();
-
-	std::stringstream finTextRender;
-	finTextRender.str("");
-	finTextRender << scoreText.str() << "                      "
-			<< timeText.str();
-
-	if (gameOver) {
-		finTextRender.str("");
-		finTextRender << textVector[3];
-	}
-	if (win) {
-		finTextRender.str("");
-		finTextRender << textVector[2];
-	}
-
-	SDL_Color color = { 255, 255, 255, 255 };
-	std::string path = "../../res/Fonts/712_serif.ttf";
-	SDL_Texture *textImage =
-			renderText(finTextRender.str().c_str(), path, color, 36, mRenderer)
-					== 0 ?
-					renderText(finTextRender.str().c_str(),
-							"res/Fonts/712_serif.ttf", color, 36, mRenderer) :
-					renderText(finTextRender.str().c_str(), path, color, 36,
-							mRenderer);
-	renderTexture(textImage, mRenderer, 0, 0);
+	mLevel->draw(mRenderer);
+	mHud->draw(0, 0);
 
-	SDL_DestroyTexture(textImage);
+#ifdef ENGINE_PROFILER
+	if (Profiler::getInstance().overlayVisible()) {
+		renderProfiler();
+	}
+#endif
 
+	PROFILE_SCOPE(PRESENT);
 	SDL_RenderPresent(mRenderer);
 }
 
-// Render text
-SDL_Texture* SDLGraphicsProgram::renderText(const std::string &message,
-		const std::string &fontFile, SDL_Color color, int fontSize,
-		SDL_Renderer *renderer) {
-	//Open the font
-	TTF_Font *font = TTF_OpenFont(fontFile.c_str(), fontSize);
-	if (font == nullptr) {
-		//logSDLError(std::cout, "TTF_OpenFont");
-		return nullptr;
+// Lay the HUD out again only when the score, the whole frames per second
+// or the win or lose message changes
+void SDLGraphicsProgram::updateHud() {
+	int score = mLevel->getScore();
+	int fps = int(avgFPS + 0.5f);
+	int state = win ? 2 : gameOver ? 1 : 0;
+	if (score == mHudScore && fps == mHudFps && state == mHudState) {
+		return;
 	}
-	//We need to first render to a surface as that's what TTF_RenderText
-	//returns, then load that surface into a texture
-	SDL_Surface *surf = TTF_RenderUTF8_Blended(font, message.c_str(), color);
-	if (surf == nullptr) {
-		TTF_CloseFont(font);
-		logSDLError(std::cout, "TTF_RenderText");
-		return nullptr;
-	}
-	SDL_Texture *texture = SDL_CreateTextureFromSurface(renderer, surf);
-	if (texture == nullptr) {
-		logSDLError(std::cout, "CreateTexture");
+	mHudScore = score;
+	mHudFps = fps;
+	mHudState = state;
+
+	if (win) {
+		mHud->setText(textVector[2]);
+	} else if (gameOver) {
+		mHud->setText(textVector[3]);
+	} else {
+		char line[256];
+		std::snprintf(line, sizeof(line),
+				"%s%d                      FPS: %d",
+				textVector[0].c_str(), score, fps);
+		mHud->setText(line);
 	}
-	//Clean up the surface and font
-	SDL_FreeSurface(surf);
-	TTF_CloseFont(font);
-	return texture;
 }
 
-// Renders a texture with specified width and height
-void SDLGraphicsProgram::renderTexture(SDL_Texture *tex, SDL_Renderer *ren,
-		int x, int y, int w, int h) {
-	// Set up the destination rectangle to be at the given position with the given dimensions
-	SDL_Rect dst { x, y, w, h };
-	SDL_RenderCopy(ren, tex, NULL, &dst);
-}
+#ifdef ENGINE_PROFILER
+// The frame graph along the bottom and the summary under the HUD.  The
+// summary is only worked out again a few times a second, as sorting the
+// history for its percentiles costs more than the frames being measured
+void SDLGraphicsProgram::renderProfiler() {
+	Profiler &profiler = Profiler::getInstance();
+	SDL_Rect graph = { 10, mLevel->h() - 110, std::min(mLevel->w() - 20,
+			Profiler::HISTORY * 2), 100 };
+	profiler.renderGraph(mRenderer, graph);
+
+	Uint32 now = SDL_GetTicks();
+	if (mProfilerText.empty() || now - mProfilerTextTime >= 250) {
+		std::vector<std::string> lines = profiler.summary();
+		char copies[64];
+		std::snprintf(copies, sizeof(copies),
+				"shared_ptr copies: %u last frame, %u peak",
+				OwnershipStats::lastFrame(), OwnershipStats::peak());
+		lines.push_back(copies);
+		mProfilerText.resize(lines.size(), TextRenderer::Label(*mProfilerFont));
+		for (std::size_t i = 0; i < lines.size(); i++) {
+			mProfilerText[i].setText(lines[i]);
+		}
+		mProfilerTextTime = now;
+	}
 
-// Renders texture using texture's own width and height
-void SDLGraphicsProgram::renderTexture(SDL_Texture *tex, SDL_Renderer *ren,
-		int x, int y) {
-	int w, h;
-	SDL_QueryTexture(tex, NULL, NULL, &w, &h);
-	renderTexture(tex, ren, x, y, w, h);
+	const int lineHeight = 18;
+	SDL_Rect backdrop = { 10, 50, 460, int(mProfilerText.size()) * lineHeight
+			+ 4 };
+	SDL_SetRenderDrawBlendMode(mRenderer, SDL_BLENDMODE_BLEND);
+	SDL_SetRenderDrawColor(mRenderer, 0x00, 0x00, 0x00, 0xB0);
+	SDL_RenderFillRect(mRenderer, &backdrop);
+	SDL_SetRenderDrawBlendMode(mRenderer, SDL_BLENDMODE_NONE);
+	int y = backdrop.y + 2;
+	for (TextRenderer::Label &text : mProfilerText) {
+		text.draw(backdrop.x + 4, y);
+		y += lineHeight;
+	}
 }
+#endif
 
 //Loops forever!
 void SDLGraphicsProgram::loop() {
@@ -221,52 +308,70 @@ void SDLGraphicsProgram::loop() {
 	// that are related to input and output
 	SDL_Event e;
 
-	mLevel->initialize(mRenderer);
+	startLevel();
 	Mix_PlayMusic(ResourceManager::getInstance().bgm, -1);
 	loadText();
+	if (mPipelined) {
+		mSimulation.start([this]() { simulate(); });
+	}
 	int countedFrames = 0;
 	fpsTimer.start();
+	// real time not yet simulated, in seconds
+	double accumulator = 0.0;
+	const double counterFrequency = SDL_GetPerformanceFrequency();
+	Uint64 lastCounter = SDL_GetPerformanceCounter();
 	// While application is running
 	while (!quit) {
-		InputManager::getInstance().resetForFrame();
 		capTimer.start();
-		//Handle events on queue
-		while (SDL_PollEvent(&e) != 0) {
-			if (e.type == SDL_QUIT) {
-				quit = true;
-			}
-			if (e.type == SDL_KEYDOWN) {
-				if (e.key.keysym.sym == SDLK_q) {
+		{
+			PROFILE_SCOPE(EVENTS);
+			ALLOC_SCOPE(EVENTS);
+			//Handle events on queue
+			while (SDL_PollEvent(&e) != 0) {
+				if (e.type == SDL_QUIT) {
 					quit = true;
 				}
-				if (!mLevel->getEditingMode()) {
-					if (e.key.keysym.sym == SDLK_r) {
-						gameOver = false;
-						if (win) {
+				if (e.type == SDL_RENDER_TARGETS_RESET) {
+					mLevel->invalidateStaticLayer();
+				}
+				if (e.type == SDL_KEYDOWN) {
+					if (e.key.keysym.sym == SDLK_q) {
+						quit = true;
+					}
+#ifdef ENGINE_PROFILER
+					if (e.key.keysym.sym == SDLK_F3) {
+						Profiler::getInstance().toggleOverlay();
+					}
+#endif
+					if (!mLevel->getEditingMode()) {
+						if (e.key.keysym.sym == SDLK_r) {
+							gameOver = false;
+							if (win) {
+								win = false;
+								mLevelNum = 0;
+								mLevel->finalize();
+								mLevel = gameLevels[mLevelNum];
+							}
+							startLevel();
+							Mix_PlayMusic(ResourceManager::getInstance().bgm, -1);
+						}
+						if (e.key.keysym.sym == SDLK_n) {
+							gameOver = false;
 							win = false;
-							mLevelNum = 0;
+							if (mLevelNum == 2) {
+								mLevelNum = 0;
+							} else {
+								mLevelNum++;
+							}
 							mLevel->finalize();
 							mLevel = gameLevels[mLevelNum];
+							startLevel();
+							Mix_PlayMusic(ResourceManager::getInstance().bgm, -1);
 						}
-						mLevel->initialize(mRenderer);
-						Mix_PlayMusic(ResourceManager::getInstance().bgm, -1);
-					}
-					if (e.key.keysym.sym == SDLK_n) {
-						gameOver = false;
-						win = false;
-						if (mLevelNum == 2) {
-							mLevelNum = 0;
-						} else {
-							mLevelNum++;
-						}
-						mLevel->finalize();
-						mLevel = gameLevels[mLevelNum];
-						mLevel->initialize(mRenderer);
-						Mix_PlayMusic(ResourceManager::getInstance().bgm, -1);
 					}
 				}
+				InputManager::getInstance().handleEvent(e);
 			}
-			InputManager::getInstance().handleEvent(e);
 		}
 		if (!mLevel->getEditingMode()) {
 			if (mLevel->isWin()) {
@@ -278,7 +383,7 @@ void SDLGraphicsProgram::loop() {
 				}
 				mLevel->finalize();
 				mLevel = gameLevels[mLevelNum];
-				mLevel->initialize(mRenderer);
+				startLevel();
 			}
 
 			if (mLevel->getDie()) {
@@ -290,22 +395,60 @@ void SDLGraphicsProgram::loop() {
 		if (avgFPS > 2000000) {
 			avgFPS = 0;
 		}
-		// update
+		Uint64 counter = SDL_GetPerformanceCounter();
+		accumulator += (counter - lastCounter) / counterFrequency;
+		lastCounter = counter;
+
+		// update in fixed steps for the time that has passed
+		const double timeStep = PhysicsManager::getInstance().timeStep();
+		mSteps = 0;
 		if (!win && !gameOver) {
-			update();
+			while (accumulator >= timeStep && mSteps < mMaxStepsPerFrame) {
+				accumulator -= timeStep;
+				++mSteps;
+			}
+			if (accumulator >= timeStep) {
+				accumulator = std::fmod(accumulator, timeStep);
+			}
+		} else {
+			InputManager::getInstance().resetForFrame();
+			accumulator = 0.0;
 		}
+		mInterpolation = float(accumulator / timeStep);
 
-		// render
+		// pipelined, the frame drawn is the one recorded while the last was
+		// drawn, and nothing the simulation touches is touched until it is
+		// waited for
+		if (!mPipelined) {
+			simulate();
+		}
+		mLevel->swapFrames();
+		mLevel->prepareFrame(mRenderer);
+		updateHud();
+		if (mPipelined) {
+			mSimulation.run();
+		}
 		render();
+		if (mPipelined) {
+			mSimulation.wait();
+		}
+		OwnershipStats::endFrame();
 
 		++countedFrames;
-		int frameTicks = capTimer.getTicks();
-		if (frameTicks < SCREEN_TICKS_PER_FRAME) {
-			//Wait remaining time
-			SDL_Delay(SCREEN_TICKS_PER_FRAME - frameTicks);
+		if (mFrameRateCap > 0) {
+			int frameTicks = capTimer.getTicks();
+			int ticksPerFrame = 1000 / mFrameRateCap;
+			if (frameTicks < ticksPerFrame) {
+				//Wait remaining time
+				SDL_Delay(ticksPerFrame - frameTicks);
+			}
 		}
+		PROFILE_END_FRAME();
+		ALLOC_END_FRAME();
 	}
+	mSimulation.stop();
 	mLevel->finalize();
+	mRecording.finish();
 }
 
 /**
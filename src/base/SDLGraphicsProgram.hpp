@@ -6,7 +6,10 @@
 #ifndef BASE_SDL_GRAPHICS_PROGRAM_HPP
 #define BASE_SDL_GRAPHICS_PROGRAM_HPP
 
+#include "base/InputRecording.hpp"
 #include "base/Level.hpp"
+#include "base/SimulationThread.hpp"
+#include "base/TextRenderer.hpp"
 #include <memory.h>
 #include <SDL.h>
 #include <SDL_ttf.h>
@@ -31,57 +34,66 @@ public:
   // loop that runs forever
   void loop();
 
+  static const int DEFAULT_TICK_RATE = 60; //!< Simulation steps per second unless set otherwise.
+  static const int DEFAULT_MAX_STEPS_PER_FRAME = 5; //!< Catch-up steps per frame unless set otherwise.
+  static const int FALLBACK_FRAME_RATE_CAP = 60; //!< Frame rate cap when the renderer does not wait for vsync.
+
   /**
-   * Get Pointer to Renderer
+   * Set how many fixed simulation steps run per second, whatever the
+   * frame rate.  A rate that is not positive is ignored.
+   * @param int stepsPerSecond: the tick rate
    */
-  SDL_Renderer* getSDLRenderer();
+  void setTickRate(int stepsPerSecond);
 
   /**
-   * Log an SDL Error
+   * Set the most simulation steps a single frame may run to catch up
+   * after a slow frame; time beyond that is dropped, so a machine that
+   * cannot keep up slows the game down instead of falling ever further
+   * behind
+   * @param int steps: the cap
    */
-  void logSDLError(std::ostream &os, const std::string &msg);
+  void setMaxStepsPerFrame(int steps);
 
   /**
-   * Loads display text.
+   * Set a frame rate to cap rendering at by sleeping, or 0 to render as
+   * often as the display allows.  The cap starts at 0 if the renderer
+   * waits for vsync and at FALLBACK_FRAME_RATE_CAP if it does not, as
+   * the loop would otherwise never wait.
+   * @param int framesPerSecond: the cap
    */
-  void loadText();
+  void setFrameRateCap(int framesPerSecond);
 
   /**
-   * Render the message we want to display to a texture for drawing
-   * @param message The message we want to display
-   * @param fontFile The font we want to use to render the text
-   * @param color The color we want the text to be
-   * @param fontSize The size we want the font to be
-   * @param renderer The renderer to load the texture in
-   * @return An SDL_Texture containing the rendered message, or nullptr if something went wrong
+   * Step the simulation and record the next frame on a thread of its own
+   * while the main thread draws and presents this one, so the two take
+   * as long as the slower rather than both together.  Frames are shown a
+   * frame later than when run in turn, which is the default.  Call before
+   * loop.
+   * @param bool pipelined: whether to
    */
-  SDL_Texture* renderText(const std::string &message,
-  		const std::string &fontFile, SDL_Color color, int fontSize,
-  		SDL_Renderer *renderer);
+  void setPipelined(bool pipelined);
 
   /**
-   * Draw an SDL_Texture to an SDL_Renderer at position x, y, with some desired
-   * width and height
-   * @param tex The source texture we want to draw
-   * @param ren The renderer we want to draw to
-   * @param x The x coordinate to draw to
-   * @param y The y coordinate to draw to
-   * @param w The width of the texture to draw
-   * @param h The height of the texture to draw
+   * Record the run's input, seed and level changes for HeadlessProgram to
+   * replay.  Call before loop and after setTickRate.
+   * @param const std::string& filename: where to write the recording
    */
-  void renderTexture(SDL_Texture *tex, SDL_Renderer *ren,
-  		int x, int y, int w, int h);
+  bool recordInput(const std::string &filename);
 
   /**
-   * Draw an SDL_Texture to an SDL_Renderer at position x, y, preserving
-   * the texture's width and height
-   * @param tex The source texture we want to draw
-   * @param ren The renderer we want to draw to
-   * @param x The x coordinate to draw to
-   * @param y The y coordinate to draw to
+   * Get Pointer to Renderer
    */
-  void renderTexture(SDL_Texture *tex, SDL_Renderer *ren,
-  		int x, int y);
+  SDL_Renderer* getSDLRenderer();
+
+  /**
+   * Log an SDL Error
+   */
+  void logSDLError(std::ostream &os, const std::string &msg);
+
+  /**
+   * Loads display text.
+   */
+  void loadText();
 
 private:
 
@@ -97,6 +109,37 @@ private:
   std::vector<std::shared_ptr<Level>> gameLevels;
   int mLevelNum = 0;
 
+  int mMaxStepsPerFrame = DEFAULT_MAX_STEPS_PER_FRAME;
+  int mFrameRateCap = 0;
+
+  // the steps to run and the frame to record, on mSimulation if pipelined
+  void simulate();
+  bool mPipelined = false;
+  SimulationThread mSimulation;
+  int mSteps = 0;
+  float mInterpolation = 1.0f;
+
+  std::uint32_t mSeed = 0;
+  InputRecording mRecording;
+
+  void startLevel(); // initialize mLevel and note it in any recording
+
+  // the HUD line, and what it showed when last laid out
+  void updateHud();
+  std::unique_ptr<TextRenderer> mHudFont;
+  std::unique_ptr<TextRenderer::Label> mHud;
+  int mHudScore = 0;
+  int mHudFps = 0;
+  int mHudState = -1;
+
+#ifdef ENGINE_PROFILER
+  // the profiler overlay, and its summary text
+  void renderProfiler();
+  std::unique_ptr<TextRenderer> mProfilerFont;
+  std::vector<TextRenderer::Label> mProfilerText;
+  Uint32 mProfilerTextTime = 0;
+#endif
+
 };
 
 #endif
@@ -0,0 +1,19 @@
+#include "base/SimulationClock.hpp"
+
+SimulationClock &SimulationClock::getInstance() {
+	static SimulationClock *instance = new SimulationClock();
+	return *instance;
+}
+
+void SimulationClock::startUp() {
+	mSeconds = 0.0;
+	mSteps = 0;
+}
+
+void SimulationClock::shutDown() {
+}
+
+void SimulationClock::advance(double seconds) {
+	mSeconds += seconds;
+	mSteps++;
+}
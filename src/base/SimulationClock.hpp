@@ -0,0 +1,39 @@
+#ifndef BASE_SIMULATION_CLOCK
+#define BASE_SIMULATION_CLOCK
+
+#include <SDL.h>
+#include <cstdint>
+
+//! \brief Time as the simulation sees it.  It only moves when a level
+//! steps, by the fixed time step, so gameplay timers read the same values
+//! however fast the steps run: live, flat out headless, or in a replay.
+class SimulationClock {
+private:
+
+	SimulationClock() = default; // Private Singleton
+	SimulationClock(SimulationClock const&) = delete; // Avoid copy constructor.
+	void operator=(SimulationClock const&) = delete; // Don't allow copy assignment.
+
+public:
+
+	static SimulationClock &getInstance(); //!< Get the instance.
+
+	void startUp(); //!< Reset the clock to zero.
+	void shutDown();
+
+	void advance(double seconds); //!< Move the clock on after a step.
+
+	inline double seconds() const { return mSeconds; } //!< Simulated seconds since startUp.
+	inline std::uint64_t steps() const { return mSteps; } //!< Steps since startUp.
+
+	//! Simulated milliseconds since startUp, to stand in for SDL_GetTicks.
+	inline Uint32 ticks() const { return static_cast<Uint32>(mSeconds * 1000.0); }
+
+private:
+
+	double mSeconds = 0.0;
+	std::uint64_t mSteps = 0;
+
+};
+
+#endif
@@ -0,0 +1,59 @@
+#include "base/SimulationThread.hpp"
+
+SimulationThread::SimulationThread() {
+}
+
+SimulationThread::~SimulationThread() {
+	stop();
+}
+
+void SimulationThread::start(std::function<void()> job) {
+	stop();
+	mJob = job;
+	mBusy = false;
+	mStopping = false;
+	mThread = std::thread(&SimulationThread::threadLoop, this);
+}
+
+void SimulationThread::stop() {
+	if (!mThread.joinable()) {
+		return;
+	}
+	{
+		std::unique_lock<std::mutex> lock(mMutex);
+		mChanged.wait(lock, [this]() { return !mBusy; });
+		mStopping = true;
+	}
+	mChanged.notify_all();
+	mThread.join();
+}
+
+void SimulationThread::run() {
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		mBusy = true;
+	}
+	mChanged.notify_all();
+}
+
+void SimulationThread::wait() {
+	std::unique_lock<std::mutex> lock(mMutex);
+	mChanged.wait(lock, [this]() { return !mBusy; });
+}
+
+// The job runs outside the lock; mBusy stays set until it returns, which
+// is what wait waits for
+void SimulationThread::threadLoop() {
+	std::unique_lock<std::mutex> lock(mMutex);
+	for (;;) {
+		mChanged.wait(lock, [this]() { return mBusy || mStopping; });
+		if (!mBusy) {
+			return;
+		}
+		lock.unlock();
+		mJob();
+		lock.lock();
+		mBusy = false;
+		mChanged.notify_all();
+	}
+}
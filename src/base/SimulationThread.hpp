@@ -0,0 +1,51 @@
+#ifndef BASE_SIMULATION_THREAD
+#define BASE_SIMULATION_THREAD
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+//! \brief A thread that runs one job, once each time it is asked, while
+//! the thread that asked gets on with something else.
+//!
+//! SDLGraphicsProgram uses it to step the simulation and record the next
+//! frame while the main thread, which owns the renderer, draws this one.
+//! The job is set once, at start, so handing it over each frame does not
+//! allocate.
+class SimulationThread {
+public:
+
+	SimulationThread();
+	~SimulationThread();
+
+	/**
+	 * Start the thread
+	 * @param std::function<void()> job: what each run runs
+	 */
+	void start(std::function<void()> job);
+
+	void stop(); //!< Wait for any run to finish, then end the thread.
+
+	inline bool started() const { return mThread.joinable(); } //!< Whether start was called without a stop since.
+
+	void run(); //!< Start a run of the job and return at once; the last run must be waited for.
+	void wait(); //!< Return once the last run has finished.
+
+private:
+
+	SimulationThread(const SimulationThread&) = delete;
+	void operator=(SimulationThread const&) = delete;
+
+	void threadLoop();
+
+	std::function<void()> mJob;
+	std::thread mThread;
+	std::mutex mMutex;
+	std::condition_variable mChanged; // a run asked for or finished, or stop
+	bool mBusy = false; // a run is asked for or running
+	bool mStopping = false;
+
+};
+
+#endif
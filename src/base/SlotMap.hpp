@@ -0,0 +1,160 @@
+#ifndef BASE_SLOT_MAP
+#define BASE_SLOT_MAP
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+//! \brief A stable reference to an element of a SlotMap.  The generation
+//! tells apart the different elements that have used the same slot, so a
+//! handle to a removed element never resolves to whatever replaced it.
+struct SlotHandle {
+	std::uint32_t index;
+	std::uint32_t generation; //!< 0 is never used by a live element.
+
+	inline bool operator==(const SlotHandle &other) const {
+		return index == other.index && generation == other.generation;
+	}
+	inline bool operator!=(const SlotHandle &other) const {
+		return !(*this == other);
+	}
+	inline bool isNull() const {
+		return generation == 0;
+	}
+
+	static inline SlotHandle null() {
+		SlotHandle handle = { 0, 0 };
+		return handle;
+	}
+};
+
+//! \brief A generational slot map.  Values are stored densely so they can
+//! be iterated like a vector; insertion and removal are O(1), removal by
+//! moving the last value into the hole.  Iteration order is therefore
+//! insertion order until the first removal, and deterministic after.
+template<typename T>
+class SlotMap {
+public:
+
+	typedef typename std::vector<T>::iterator iterator;
+	typedef typename std::vector<T>::const_iterator const_iterator;
+
+	/**
+	 * Insert a value and return its handle
+	 */
+	SlotHandle insert(const T &value) {
+		std::uint32_t index = acquire();
+		mSlots[index].dense = static_cast<std::uint32_t>(mValues.size());
+		mValues.push_back(value);
+		mDenseToSlot.push_back(index);
+		SlotHandle handle = { index, mSlots[index].generation };
+		return handle;
+	}
+
+	/**
+	 * Insert a value by moving it in, and return its handle
+	 */
+	SlotHandle insert(T &&value) {
+		std::uint32_t index = acquire();
+		mSlots[index].dense = static_cast<std::uint32_t>(mValues.size());
+		mValues.push_back(std::move(value));
+		mDenseToSlot.push_back(index);
+		SlotHandle handle = { index, mSlots[index].generation };
+		return handle;
+	}
+
+	/**
+	 * Remove the value a handle refers to.  Returns false for stale handles.
+	 */
+	bool erase(SlotHandle handle) {
+		if (!contains(handle)) {
+			return false;
+		}
+		std::uint32_t dense = mSlots[handle.index].dense;
+		std::uint32_t last = static_cast<std::uint32_t>(mValues.size() - 1);
+		if (dense != last) {
+			mValues[dense] = std::move(mValues[last]);
+			mDenseToSlot[dense] = mDenseToSlot[last];
+			mSlots[mDenseToSlot[dense]].dense = dense;
+		}
+		mValues.pop_back();
+		mDenseToSlot.pop_back();
+		retire(handle.index);
+		return true;
+	}
+
+	/**
+	 * Return whether a handle still refers to a value in the map
+	 */
+	inline bool contains(SlotHandle handle) const {
+		return handle.index < mSlots.size()
+				&& mSlots[handle.index].generation == handle.generation;
+	}
+
+	/**
+	 * Return the value a handle refers to, or nullptr for stale handles
+	 */
+	inline T * get(SlotHandle handle) {
+		return contains(handle) ? &mValues[mSlots[handle.index].dense] : nullptr;
+	}
+
+	/**
+	 * Remove every value.  Handles given out before stay stale.
+	 */
+	void clear() {
+		for (std::size_t i = 0; i < mDenseToSlot.size(); i++) {
+			retire(mDenseToSlot[i]);
+		}
+		mValues.clear();
+		mDenseToSlot.clear();
+	}
+
+	inline std::size_t size() const { return mValues.size(); }
+	inline bool empty() const { return mValues.empty(); }
+
+	inline T & operator[](std::size_t dense) { return mValues[dense]; }
+	inline const T & operator[](std::size_t dense) const { return mValues[dense]; }
+
+	inline iterator begin() { return mValues.begin(); }
+	inline iterator end() { return mValues.end(); }
+	inline const_iterator begin() const { return mValues.begin(); }
+	inline const_iterator end() const { return mValues.end(); }
+
+private:
+
+	struct Slot {
+		std::uint32_t dense; //!< Position of the value in mValues.
+		std::uint32_t generation; //!< Bumped each time the slot is freed.
+	};
+
+	// take a free slot, or make a new one
+	std::uint32_t acquire() {
+		if (!mFreeSlots.empty()) {
+			std::uint32_t index = mFreeSlots.back();
+			mFreeSlots.pop_back();
+			return index;
+		}
+		Slot slot = { 0, 1 };
+		mSlots.push_back(slot);
+		// room to free every slot, so erasing never allocates
+		mFreeSlots.reserve(mSlots.capacity());
+		return static_cast<std::uint32_t>(mSlots.size() - 1);
+	}
+
+	// bump the generation so outstanding handles go stale, skipping 0
+	void retire(std::uint32_t index) {
+		if (++mSlots[index].generation == 0) {
+			mSlots[index].generation = 1;
+		}
+		mFreeSlots.push_back(index);
+	}
+
+	std::vector<T> mValues;
+	std::vector<std::uint32_t> mDenseToSlot;
+	std::vector<Slot> mSlots;
+	std::vector<std::uint32_t> mFreeSlots;
+
+};
+
+#endif
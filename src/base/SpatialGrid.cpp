@@ -0,0 +1,153 @@
+#include "base/SpatialGrid.hpp"
+#include "base/GameObject.hpp"
+#include <algorithm>
+
+SpatialGrid::SpatialGrid(float cellSize) :
+		mCellSize(cellSize), mCount(0) {
+}
+
+SpatialGrid::~SpatialGrid() {
+}
+
+void SpatialGrid::setCellSize(float cellSize) {
+	if (mCount == 0 && cellSize != mCellSize) {
+		mCellSize = cellSize;
+		mCells.clear();
+	}
+}
+
+void SpatialGrid::insert(GameObject &obj) {
+	if (obj.mGridEntry.indexed) {
+		return;
+	}
+	Entry entry = entryFor(obj);
+	link(obj, entry);
+	obj.mGridEntry = entry;
+	mCount++;
+}
+
+void SpatialGrid::remove(GameObject &obj) {
+	if (!obj.mGridEntry.indexed) {
+		return;
+	}
+	unlink(obj, obj.mGridEntry);
+	obj.mGridEntry.indexed = false;
+	mCount--;
+}
+
+// Most moves stay inside the same cells, so those cost a compare
+void SpatialGrid::update(GameObject &obj) {
+	if (!obj.mGridEntry.indexed) {
+		return;
+	}
+	Entry entry = entryFor(obj);
+	const Entry &old = obj.mGridEntry;
+	if (entry.x0 == old.x0 && entry.y0 == old.y0 && entry.x1 == old.x1
+			&& entry.y1 == old.y1) {
+		return;
+	}
+	unlink(obj, old);
+	link(obj, entry);
+	obj.mGridEntry = entry;
+}
+
+// The cells stay, so the next level reuses them rather than allocating
+void SpatialGrid::clear() {
+	for (auto &cell : mCells) {
+		for (auto obj : cell.second) {
+			obj->mGridEntry.indexed = false;
+		}
+		cell.second.clear();
+	}
+	mCount = 0;
+}
+
+void SpatialGrid::reserve(float x, float y, float w, float h,
+		std::size_t perCell) {
+	for (int cy = cellOf(y); cy <= cellOf(y + h); cy++) {
+		for (int cx = cellOf(x); cx <= cellOf(x + w); cx++) {
+			mCells[key(cx, cy)].reserve(perCell);
+		}
+	}
+}
+
+void SpatialGrid::queryPoint(float x, float y,
+		std::vector<GameObject*> &out) const {
+	auto cell = mCells.find(key(cellOf(x), cellOf(y)));
+	if (cell == mCells.end()) {
+		return;
+	}
+	for (auto obj : cell->second) {
+		if (x >= obj->x() && x < obj->x() + obj->w() && y >= obj->y()
+				&& y < obj->y() + obj->h()) {
+			out.push_back(obj);
+		}
+	}
+}
+
+void SpatialGrid::queryCell(int cx, int cy,
+		std::vector<GameObject*> &out) const {
+	auto cell = mCells.find(key(cx, cy));
+	if (cell != mCells.end()) {
+		out.insert(out.end(), cell->second.begin(), cell->second.end());
+	}
+}
+
+// An object listed in several of the cells is only reported from the
+// first of them that the query covers, so no seen-set is needed
+void SpatialGrid::queryRect(float x, float y, float w, float h,
+		std::vector<GameObject*> &out) const {
+	int x0 = cellOf(x), y0 = cellOf(y);
+	int x1 = cellOf(x + w), y1 = cellOf(y + h);
+	for (int cy = y0; cy <= y1; cy++) {
+		for (int cx = x0; cx <= x1; cx++) {
+			auto cell = mCells.find(key(cx, cy));
+			if (cell == mCells.end()) {
+				continue;
+			}
+			for (auto obj : cell->second) {
+				const Entry &entry = obj->mGridEntry;
+				if (cx != std::max(entry.x0, x0) || cy != std::max(entry.y0, y0)) {
+					continue;
+				}
+				if (obj->x() < x + w && obj->x() + obj->w() > x
+						&& obj->y() < y + h && obj->y() + obj->h() > y) {
+					out.push_back(obj);
+				}
+			}
+		}
+	}
+}
+
+SpatialGrid::Entry SpatialGrid::entryFor(const GameObject &obj) const {
+	Entry entry = { cellOf(obj.x()), cellOf(obj.y()), cellOf(obj.x() + obj.w()),
+			cellOf(obj.y() + obj.h()), true };
+	return entry;
+}
+
+void SpatialGrid::link(GameObject &obj, const Entry &entry) {
+	for (int cy = entry.y0; cy <= entry.y1; cy++) {
+		for (int cx = entry.x0; cx <= entry.x1; cx++) {
+			mCells[key(cx, cy)].push_back(&obj);
+		}
+	}
+}
+
+// Cells hold a handful of objects, so a linear find is fine.  Emptied
+// cells are kept, so objects moving back and forth don't reallocate them.
+void SpatialGrid::unlink(GameObject &obj, const Entry &entry) {
+	for (int cy = entry.y0; cy <= entry.y1; cy++) {
+		for (int cx = entry.x0; cx <= entry.x1; cx++) {
+			auto cell = mCells.find(key(cx, cy));
+			if (cell == mCells.end()) {
+				continue;
+			}
+			std::vector<GameObject*> &objects = cell->second;
+			auto it = std::find(objects.begin(), objects.end(), &obj);
+			if (it != objects.end()) {
+				*it = objects.back();
+				objects.pop_back();
+			}
+		}
+	}
+}
@@ -0,0 +1,88 @@
+#ifndef BASE_SPATIAL_GRID
+#define BASE_SPATIAL_GRID
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+class GameObject;
+
+//! \brief A uniform grid over the plane, hashed so it needs no bounds.
+//! Each object is listed in every cell its rectangle overlaps, so a query
+//! only looks at the objects in the cells it touches rather than at every
+//! object in the level.
+class SpatialGrid {
+public:
+
+	//! The cells an object is listed in; kept in the object itself.
+	struct Entry {
+		int x0, y0, x1, y1; //!< Inclusive cell range.
+		bool indexed;
+	};
+
+	SpatialGrid(float cellSize);
+	~SpatialGrid();
+
+	/**
+	 * Change the cell size; only allowed while the grid is empty
+	 * @param float cellSize: width and height of a cell
+	 */
+	void setCellSize(float cellSize);
+	inline float cellSize() const { return mCellSize; }
+
+	void insert(GameObject &obj); //!< List an object under the cells it overlaps.
+	void remove(GameObject &obj); //!< Take an object out of the grid.
+	void update(GameObject &obj); //!< Move an indexed object to its current cells, if they changed.
+	void clear(); //!< Take every object out of the grid, keeping the cells.
+
+	/**
+	 * Make the cells a rectangle overlaps ahead of time, each with room for
+	 * some objects, so objects moving into them need not allocate
+	 * @param std::size_t perCell: objects each cell has room for
+	 */
+	void reserve(float x, float y, float w, float h, std::size_t perCell);
+
+	inline std::size_t size() const { return mCount; } //!< Number of objects in the grid.
+
+	/**
+	 * Append the objects containing a point
+	 */
+	void queryPoint(float x, float y, std::vector<GameObject*> &out) const;
+
+	/**
+	 * Append the objects overlapping a cell
+	 * @param int cx, int cy: column and row of the cell
+	 */
+	void queryCell(int cx, int cy, std::vector<GameObject*> &out) const;
+
+	/**
+	 * Append the objects overlapping a rectangle, each once
+	 */
+	void queryRect(float x, float y, float w, float h,
+			std::vector<GameObject*> &out) const;
+
+	inline int cellOf(float coordinate) const { return static_cast<int>(std::floor(coordinate / mCellSize)); } //!< Column or row of a coordinate.
+
+private:
+
+	SpatialGrid(const SpatialGrid&) = delete;
+	void operator=(SpatialGrid const&) = delete;
+
+	static inline std::uint64_t key(int cx, int cy) {
+		return (static_cast<std::uint64_t>(static_cast<std::uint32_t>(cx)) << 32)
+				| static_cast<std::uint32_t>(cy);
+	}
+
+	Entry entryFor(const GameObject &obj) const;
+	void link(GameObject &obj, const Entry &entry);
+	void unlink(GameObject &obj, const Entry &entry);
+
+	float mCellSize;
+	std::size_t mCount;
+	std::unordered_map<std::uint64_t, std::vector<GameObject*>> mCells;
+
+};
+
+#endif
@@ -0,0 +1,106 @@
+#include "base/SpriteAtlas.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// space left around each image, so sampling at an edge does not pick up
+// its neighbour
+const int PADDING = 1;
+
+}
+
+const int SpriteAtlas::MAX_WIDTH;
+
+SpriteAtlas::SpriteAtlas() {
+}
+
+SpriteAtlas::~SpriteAtlas() {
+	clear();
+}
+
+void SpriteAtlas::clear() {
+	SDL_FreeSurface(mSurface);
+	mSurface = nullptr;
+	mRegions.clear();
+}
+
+// Shelf packing, tallest images first so each shelf wastes little height.
+// The width is the smallest power of two that could hold the images'
+// total area in a square, or the widest image
+bool SpriteAtlas::build(const std::vector<SDL_Surface*> &surfaces) {
+	clear();
+	if (surfaces.empty()) {
+		return true;
+	}
+	std::vector<SDL_Surface*> order(surfaces);
+	std::sort(order.begin(), order.end(), [](SDL_Surface *a, SDL_Surface *b) {
+		return a->h > b->h;
+	});
+
+	long area = 0;
+	int widest = 0;
+	for (SDL_Surface *image : order) {
+		area += long(image->w + PADDING) * (image->h + PADDING);
+		widest = std::max(widest, image->w + PADDING);
+	}
+	int width = 64;
+	while (width < MAX_WIDTH
+			&& (width < widest || width < std::sqrt(double(area)))) {
+		width *= 2;
+	}
+	if (widest > width) {
+		SDL_Log("Sprites are too wide for the atlas");
+		return false;
+	}
+
+	int x = 0;
+	int y = 0;
+	int shelfHeight = 0;
+	for (SDL_Surface *image : order) {
+		if (mRegions.count(image) > 0) {
+			continue;
+		}
+		if (x + image->w + PADDING > width) {
+			x = 0;
+			y += shelfHeight;
+			shelfHeight = 0;
+		}
+		SDL_Rect region = { x, y, image->w, image->h };
+		mRegions[image] = region;
+		x += image->w + PADDING;
+		shelfHeight = std::max(shelfHeight, image->h + PADDING);
+	}
+
+	mSurface = SDL_CreateRGBSurfaceWithFormat(0, width, y + shelfHeight, 32,
+			SDL_PIXELFORMAT_ARGB8888);
+	if (mSurface == nullptr) {
+		SDL_Log("Failed to create sprite atlas");
+		mRegions.clear();
+		return false;
+	}
+	for (auto &packed : mRegions) {
+		// copy pixels and alpha as they are, whatever the image's format
+		SDL_Surface *image = SDL_ConvertSurfaceFormat(packed.first,
+				SDL_PIXELFORMAT_ARGB8888, 0);
+		if (image == nullptr) {
+			continue;
+		}
+		SDL_SetSurfaceBlendMode(image, SDL_BLENDMODE_NONE);
+		SDL_Rect dest = packed.second;
+		SDL_BlitSurface(image, nullptr, mSurface, &dest);
+		SDL_FreeSurface(image);
+	}
+	SDL_Log("Packed %d sprites into a %dx%d atlas", int(mRegions.size()),
+			mSurface->w, mSurface->h);
+	return true;
+}
+
+Sprite SpriteAtlas::sprite(SDL_Texture *texture, SDL_Surface *image) const {
+	Sprite sprite = { texture, { 0, 0, 0, 0 } };
+	auto found = mRegions.find(image);
+	if (found != mRegions.end()) {
+		sprite.source = found->second;
+	}
+	return sprite;
+}
@@ -0,0 +1,52 @@
+#ifndef BASE_SPRITE_ATLAS
+#define BASE_SPRITE_ATLAS
+
+#include <SDL.h>
+#include <unordered_map>
+#include <vector>
+
+//! A region of a texture to draw as a sprite.
+struct Sprite {
+	SDL_Texture *texture;
+	SDL_Rect source;
+};
+
+//! \brief Many images packed into one surface, so sprites drawn from any
+//! of them share a texture and can be drawn in one batch.
+class SpriteAtlas {
+public:
+
+	static const int MAX_WIDTH = 2048; //!< Widest the atlas is made.
+
+	SpriteAtlas();
+	~SpriteAtlas();
+
+	/**
+	 * Pack surfaces into the atlas, replacing what it held; the surfaces
+	 * themselves are left alone.  Returns false if they do not fit.
+	 * @param const std::vector<SDL_Surface*>& surfaces: the images
+	 */
+	bool build(const std::vector<SDL_Surface*> &surfaces);
+
+	void clear(); //!< Free the packed surface and forget the regions.
+
+	inline SDL_Surface *surface() const { return mSurface; } //!< The packed images, or NULL before build.
+
+	/**
+	 * The sprite a packed surface became, in a texture made from surface()
+	 * @param SDL_Texture* texture: the atlas texture, or NULL when headless
+	 * @param SDL_Surface* image: one of the surfaces given to build
+	 */
+	Sprite sprite(SDL_Texture *texture, SDL_Surface *image) const;
+
+private:
+
+	SpriteAtlas(const SpriteAtlas&) = delete;
+	void operator=(SpriteAtlas const&) = delete;
+
+	SDL_Surface *mSurface = nullptr;
+	std::unordered_map<SDL_Surface*, SDL_Rect> mRegions;
+
+};
+
+#endif
@@ -0,0 +1,74 @@
+#include "base/SpriteBatch.hpp"
+
+SpriteBatch::SpriteBatch() {
+}
+
+void SpriteBatch::begin(SDL_Renderer *renderer) {
+	mRenderer = renderer;
+	mTexture = nullptr;
+	mQuads.clear();
+	mDrawCalls = 0;
+}
+
+void SpriteBatch::draw(const Sprite &sprite, const SDL_FRect &dest) {
+	if (sprite.texture == nullptr) {
+		return;
+	}
+	if (sprite.texture != mTexture) {
+		flush();
+		mTexture = sprite.texture;
+	}
+	Quad quad = { sprite.source, dest };
+	mQuads.push_back(quad);
+}
+
+void SpriteBatch::flush() {
+	if (mQuads.empty() || mRenderer == nullptr) {
+		mQuads.clear();
+		return;
+	}
+
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+	int textureW, textureH;
+	SDL_QueryTexture(mTexture, nullptr, nullptr, &textureW, &textureH);
+	const float scaleX = 1.0f / textureW;
+	const float scaleY = 1.0f / textureH;
+	const SDL_Color white = { 0xFF, 0xFF, 0xFF, 0xFF };
+
+	mVertices.clear();
+	for (const Quad &quad : mQuads) {
+		for (int corner = 0; corner < 4; corner++) {
+			int right = corner & 1;
+			int bottom = corner >> 1;
+			SDL_Vertex v;
+			v.position.x = quad.dest.x + right * quad.dest.w;
+			v.position.y = quad.dest.y + bottom * quad.dest.h;
+			v.color = white;
+			v.tex_coord.x = (quad.source.x + right * quad.source.w) * scaleX;
+			v.tex_coord.y = (quad.source.y + bottom * quad.source.h) * scaleY;
+			mVertices.push_back(v);
+		}
+	}
+	const int corners[] = { 0, 1, 2, 2, 1, 3 };
+	for (std::size_t quad = mIndices.size() / 6; quad < mQuads.size(); quad++) {
+		for (int corner : corners) {
+			mIndices.push_back(int(quad * 4) + corner);
+		}
+	}
+	SDL_RenderGeometry(mRenderer, mTexture, mVertices.data(),
+			int(mVertices.size()), mIndices.data(), int(mQuads.size() * 6));
+	mDrawCalls++;
+#else
+	for (const Quad &quad : mQuads) {
+		SDL_RenderCopyF(mRenderer, mTexture, &quad.source, &quad.dest);
+		mDrawCalls++;
+	}
+#endif
+	mQuads.clear();
+}
+
+void SpriteBatch::end() {
+	flush();
+	mRenderer = nullptr;
+	mTexture = nullptr;
+}
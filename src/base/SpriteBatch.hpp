@@ -0,0 +1,54 @@
+#ifndef BASE_SPRITE_BATCH
+#define BASE_SPRITE_BATCH
+
+#include "base/SpriteAtlas.hpp"
+#include <SDL.h>
+#include <vector>
+
+//! \brief Collects the sprites drawn in a frame and submits each run of
+//! them that shares a texture as one SDL_RenderGeometry call.
+//!
+//! Sprites from one SpriteAtlas all share its texture, so a level drawn
+//! from an atlas costs one call however many sprites it has.  On SDL older
+//! than 2.0.18 each sprite is copied on its own, still at float positions.
+class SpriteBatch {
+public:
+
+	SpriteBatch();
+
+	void begin(SDL_Renderer *renderer); //!< Start collecting sprites to draw with a renderer.
+
+	/**
+	 * Queue a sprite; it is drawn by the next flush or end
+	 * @param const Sprite& sprite: the texture region to draw
+	 * @param const SDL_FRect& dest: where to draw it
+	 */
+	void draw(const Sprite &sprite, const SDL_FRect &dest);
+
+	void flush(); //!< Draw the sprites queued so far.
+	void end(); //!< Draw what is left and stop collecting.
+
+	inline int drawCalls() const { return mDrawCalls; } //!< Calls made to the renderer since begin.
+
+private:
+
+	SpriteBatch(const SpriteBatch&) = delete;
+	void operator=(SpriteBatch const&) = delete;
+
+	struct Quad {
+		SDL_Rect source;
+		SDL_FRect dest;
+	};
+
+	SDL_Renderer *mRenderer = nullptr;
+	SDL_Texture *mTexture = nullptr; // of the queued quads
+	std::vector<Quad> mQuads;
+	int mDrawCalls = 0;
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+	std::vector<SDL_Vertex> mVertices;
+	std::vector<int> mIndices; // the same two triangles per quad; only grows
+#endif
+
+};
+
+#endif
@@ -1,29 +1,26 @@
 #include "base/SpriteRenderComponent.hpp"
 #include "base/GameObject.hpp"
+#include "base/Level.hpp"
 #include <SDL.h>
 #include <vector>
 
 SpriteRenderComponent::SpriteRenderComponent(GameObject &gameObject,
-		std::vector<SDL_Texture*> textures) :
-		RenderComponent(gameObject), playerTextures(textures) {
+		std::vector<Sprite> sprites) :
+		RenderComponent(gameObject), playerSprites(sprites) {
 }
 
 void SpriteRenderComponent::render(SDL_Renderer *renderer) const {
 	const GameObject &gameObject = getGameObject();
-	SDL_Rect SrcR;
-	SDL_Rect DestR;
+	const Camera &camera = gameObject.level().camera();
+	SDL_FRect DestR;
 
-	SrcR.x = 0;
-	SrcR.y = 0;
-	SrcR.w = 100;
-	SrcR.h = 100;
-
-	DestR.x = gameObject.x();
-	DestR.y = gameObject.y();
+	DestR.x = camera.toScreenX(gameObject.renderX());
+	DestR.y = camera.toScreenY(gameObject.renderY());
 	DestR.w = gameObject.w();
 	DestR.h = gameObject.h();
 
-	SDL_RenderCopy(renderer, playerTextures[spriteToRender], &SrcR, &DestR);
+	gameObject.level().drawList().draw(layer(), playerSprites[spriteToRender],
+			DestR);
 }
 
 void SpriteRenderComponent::setSprite(int newSprite) {
@@ -2,14 +2,16 @@
 #define BASE_SPRITE_RENDER_COMPONENT
 
 #include "base/RenderComponent.hpp"
+#include "base/SpriteAtlas.hpp"
 #include <SDL.h>
 #include <vector>
 
-//! \brief Handles rendering a game object with a sprite.
+//! \brief Handles rendering a game object with a sprite, queued in its
+//! level's draw list.
 class SpriteRenderComponent: public RenderComponent {
 public:
 
-	SpriteRenderComponent(GameObject &gameObject, std::vector<SDL_Texture*> textures);
+	SpriteRenderComponent(GameObject &gameObject, std::vector<Sprite> sprites);
 
 	virtual void render(SDL_Renderer *renderer) const override;
 
@@ -18,7 +20,7 @@ public:
 	int getSprite();
 
 private:
-	std::vector<SDL_Texture*> playerTextures;
+	std::vector<Sprite> playerSprites;
 	int spriteToRender { 0 };
 };
 
@@ -0,0 +1,140 @@
+#include "base/StaticLayer.hpp"
+#include "base/Level.hpp"
+#include <cmath>
+
+const std::size_t StaticLayer::MAX_CHUNKS;
+
+StaticLayer::StaticLayer() {
+}
+
+StaticLayer::~StaticLayer() {
+	release();
+}
+
+void StaticLayer::setChunkSize(int w, int h) {
+	release();
+	mChunkW = w > 0 ? w : 1;
+	mChunkH = h > 0 ? h : 1;
+}
+
+void StaticLayer::invalidate() {
+	for (auto &entry : mChunks) {
+		entry.second.dirty = true;
+	}
+}
+
+// Chunks not made yet will be drawn when made, so only made ones are marked
+void StaticLayer::invalidate(float x, float y, float w, float h) {
+	int cx0 = int(std::floor(x / mChunkW));
+	int cy0 = int(std::floor(y / mChunkH));
+	int cx1 = int(std::floor((x + w) / mChunkW));
+	int cy1 = int(std::floor((y + h) / mChunkH));
+	for (int cy = cy0; cy <= cy1; cy++) {
+		for (int cx = cx0; cx <= cx1; cx++) {
+			auto found = mChunks.find(key(cx, cy));
+			if (found != mChunks.end()) {
+				found->second.dirty = true;
+			}
+		}
+	}
+}
+
+void StaticLayer::release() {
+	for (auto &entry : mChunks) {
+		SDL_DestroyTexture(entry.second.texture);
+	}
+	mChunks.clear();
+	mCopies.clear();
+	mReady = false;
+	mRenderer = nullptr;
+}
+
+StaticLayer::Chunk *StaticLayer::chunk(int cx, int cy) {
+	auto found = mChunks.find(key(cx, cy));
+	if (found != mChunks.end()) {
+		return &found->second;
+	}
+	if (mChunks.size() >= MAX_CHUNKS) {
+		evict();
+	}
+	SDL_Texture *texture = SDL_CreateTexture(mRenderer,
+			SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_TARGET, mChunkW,
+			mChunkH);
+	if (texture == nullptr) {
+		SDL_Log("Failed to create static layer chunk: %s", SDL_GetError());
+		return nullptr;
+	}
+	SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
+	Chunk &made = mChunks[key(cx, cy)];
+	made.texture = texture;
+	made.dirty = true;
+	made.lastShown = mFrame;
+	return &made;
+}
+
+void StaticLayer::evict() {
+	auto oldest = mChunks.end();
+	for (auto i = mChunks.begin(); i != mChunks.end(); ++i) {
+		if (i->second.lastShown != mFrame
+				&& (oldest == mChunks.end()
+						|| i->second.lastShown < oldest->second.lastShown)) {
+			oldest = i;
+		}
+	}
+	if (oldest != mChunks.end()) {
+		SDL_DestroyTexture(oldest->second.texture);
+		mChunks.erase(oldest);
+	}
+}
+
+bool StaticLayer::prepare(SDL_Renderer *renderer, Level &level, float viewX,
+		float viewY) {
+	mCopies.clear();
+	mReady = false;
+	if (renderer == nullptr || !SDL_RenderTargetSupported(renderer)) {
+		return false;
+	}
+	if (renderer != mRenderer) {
+		release();
+		mRenderer = renderer;
+	}
+	mFrame++;
+
+	const Camera &camera = level.camera();
+	int cx0 = int(std::floor(viewX / mChunkW));
+	int cy0 = int(std::floor(viewY / mChunkH));
+	int cx1 = int(std::ceil((viewX + camera.w()) / mChunkW)) - 1;
+	int cy1 = int(std::ceil((viewY + camera.h()) / mChunkH)) - 1;
+	for (int cy = cy0; cy <= cy1; cy++) {
+		for (int cx = cx0; cx <= cx1; cx++) {
+			Chunk *c = chunk(cx, cy);
+			if (c == nullptr) {
+				// draw nothing rather than half the layer
+				release();
+				return false;
+			}
+			SDL_Rect area = { cx * mChunkW, cy * mChunkH, mChunkW, mChunkH };
+			if (c->dirty) {
+				SDL_Texture *target = SDL_GetRenderTarget(renderer);
+				SDL_SetRenderTarget(renderer, c->texture);
+				SDL_SetRenderDrawColor(renderer, 0x00, 0x00, 0x00, 0x00);
+				SDL_RenderClear(renderer);
+				level.renderStatic(renderer, area);
+				SDL_SetRenderTarget(renderer, target);
+				c->dirty = false;
+			}
+			c->lastShown = mFrame;
+			Copy copy = { c->texture, { int(std::floor(area.x - viewX)),
+					int(std::floor(area.y - viewY)), mChunkW, mChunkH } };
+			mCopies.push_back(copy);
+		}
+	}
+	mReady = true;
+	return true;
+}
+
+void StaticLayer::draw(SDL_Renderer *renderer) const {
+	for (const Copy &copy : mCopies) {
+		SDL_RenderCopy(renderer, copy.texture, nullptr, &copy.dest);
+	}
+}
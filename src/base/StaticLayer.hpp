@@ -0,0 +1,92 @@
+#ifndef BASE_STATIC_LAYER
+#define BASE_STATIC_LAYER
+
+#include <SDL.h>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+class Level;
+
+//! \brief A level's static objects on render layer 0 drawn into textures
+//! once and copied to the screen each frame, under everything else,
+//! instead of drawn again every frame.
+//!
+//! The world is cut into chunks the size of the view, so a view that does
+//! not scroll copies one texture and a scrolling one at most four.  A
+//! chunk is drawn when it first comes into view and again only after a
+//! static object in it enters or leaves the level.  Chunks long out of
+//! view are dropped once there are more than MAX_CHUNKS.
+//!
+//! A frame's chunks are brought up to date by prepare, which reads the
+//! level's objects, and copied by draw, which reads only what prepare left
+//! it; so draw may run while the next frame is being simulated.
+class StaticLayer {
+public:
+
+	static const std::size_t MAX_CHUNKS = 16; //!< Chunk textures kept at most.
+
+	StaticLayer();
+	~StaticLayer();
+
+	/**
+	 * Set the size of a chunk, dropping the chunks drawn so far
+	 * @param int w, int h: width and height in level coordinates
+	 */
+	void setChunkSize(int w, int h);
+
+	void invalidate(); //!< Draw every chunk again before it is next shown.
+	void invalidate(float x, float y, float w, float h); //!< Draw the chunks a rectangle touches again.
+	void release(); //!< Destroy the chunk textures, e.g. before their renderer is destroyed.
+
+	/**
+	 * Bring the chunks a view of the level sees up to date, drawing any
+	 * that need it with Level::renderStatic, and note them for draw.
+	 * Returns false, leaving nothing to draw, when the renderer cannot
+	 * render to textures; the level then draws its static objects itself.
+	 * @param SDL_Renderer* renderer: the renderer
+	 * @param Level& level: the level the layer belongs to
+	 * @param float viewX, float viewY: top left of the view, in level coordinates
+	 */
+	bool prepare(SDL_Renderer *renderer, Level &level, float viewX, float viewY);
+
+	void draw(SDL_Renderer *renderer) const; //!< Copy the chunks the last prepare noted to the screen.
+
+	inline bool ready() const { return mReady; } //!< Whether the last prepare left the static objects to the layer.
+
+private:
+
+	StaticLayer(const StaticLayer&) = delete;
+	void operator=(StaticLayer const&) = delete;
+
+	//! A chunk to copy, and where to.
+	struct Copy {
+		SDL_Texture *texture;
+		SDL_Rect dest;
+	};
+
+	struct Chunk {
+		SDL_Texture *texture;
+		bool dirty;
+		unsigned int lastShown; // frame the chunk was last copied to the screen
+	};
+
+	static inline std::uint64_t key(int cx, int cy) {
+		return (static_cast<std::uint64_t>(static_cast<std::uint32_t>(cx)) << 32)
+				| static_cast<std::uint32_t>(cy);
+	}
+
+	Chunk *chunk(int cx, int cy); // made if need be; nullptr if that fails
+	void evict(); // drop the chunk shown longest ago, if not shown this frame
+
+	SDL_Renderer *mRenderer = nullptr; // the chunks' textures belong to
+	int mChunkW = 1;
+	int mChunkH = 1;
+	std::unordered_map<std::uint64_t, Chunk> mChunks;
+	unsigned int mFrame = 0;
+	std::vector<Copy> mCopies; // for draw
+	bool mReady = false;
+
+};
+
+#endif
@@ -0,0 +1,255 @@
+#include "base/TextRenderer.hpp"
+#include "base/ResourceManager.hpp"
+#include <algorithm>
+
+namespace {
+
+// space left around each glyph in the atlas, so filtering does not bleed
+// one glyph into the next
+const int GLYPH_PADDING = 1;
+
+// Decode the UTF-8 character at text, moving text past it.  Characters
+// SDL_ttf's 16-bit glyph calls cannot name, and malformed bytes, come
+// back as '?'
+Uint16 nextCharacter(const char *&text) {
+	const unsigned char *bytes = reinterpret_cast<const unsigned char*>(text);
+	Uint32 ch = bytes[0];
+	int length = 1;
+	if (ch >= 0xF0) {
+		length = 4;
+		ch = '?';
+	} else if (ch >= 0xE0) {
+		length = 3;
+		ch &= 0x0F;
+	} else if (ch >= 0xC0) {
+		length = 2;
+		ch &= 0x1F;
+	} else if (ch >= 0x80) {
+		ch = '?';
+	}
+	for (int i = 1; i < length; i++) {
+		if ((bytes[i] & 0xC0) != 0x80) {
+			text += i;
+			return '?';
+		}
+		if (length < 4) {
+			ch = (ch << 6) | (bytes[i] & 0x3F);
+		}
+	}
+	text += length;
+	return static_cast<Uint16>(ch);
+}
+
+}
+
+const int TextRenderer::ATLAS_SIZE;
+
+TextRenderer::TextRenderer(SDL_Renderer *renderer, const std::string &fontFile,
+		int fontSize) :
+		mRenderer(renderer) {
+	if (renderer == nullptr) {
+		return;
+	}
+	mFont = ResourceManager::getInstance().loadFont(fontFile, fontSize);
+	if (mFont == nullptr) {
+		return;
+	}
+	mLineHeight = TTF_FontHeight(mFont);
+	mAtlas = SDL_CreateRGBSurfaceWithFormat(0, ATLAS_SIZE, ATLAS_SIZE, 32,
+			SDL_PIXELFORMAT_ARGB8888);
+	mTexture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888,
+			SDL_TEXTUREACCESS_STATIC, ATLAS_SIZE, ATLAS_SIZE);
+	if (mAtlas == nullptr || mTexture == nullptr) {
+		SDL_Log("Failed to create glyph atlas: %s", SDL_GetError());
+		SDL_FreeSurface(mAtlas);
+		mAtlas = nullptr;
+		return;
+	}
+	SDL_SetTextureBlendMode(mTexture, SDL_BLENDMODE_BLEND);
+	// start from a clear texture; a new surface is already zeroed
+	SDL_UpdateTexture(mTexture, nullptr, mAtlas->pixels, mAtlas->pitch);
+}
+
+// The font belongs to the ResourceManager
+TextRenderer::~TextRenderer() {
+	SDL_DestroyTexture(mTexture);
+	SDL_FreeSurface(mAtlas);
+}
+
+// Glyphs go left to right along shelves as tall as the tallest glyph on
+// them; a glyph with no room left is remembered as empty rather than
+// tried again every layout
+const TextRenderer::Glyph &TextRenderer::glyph(Uint16 ch) {
+	auto found = mGlyphs.find(ch);
+	if (found != mGlyphs.end()) {
+		return found->second;
+	}
+	Glyph &g = mGlyphs[ch];
+	g.source = { 0, 0, 0, 0 };
+	g.advance = 0;
+	int minX, maxX, minY, maxY;
+	if (TTF_GlyphMetrics(mFont, ch, &minX, &maxX, &minY, &maxY, &g.advance)
+			!= 0) {
+		return g;
+	}
+	SDL_Color white = { 255, 255, 255, 255 };
+	SDL_Surface *rendered = TTF_RenderGlyph_Blended(mFont, ch, white);
+	if (rendered == nullptr) {
+		// e.g. a space, which has an advance and nothing to draw
+		return g;
+	}
+
+	if (mPenX + rendered->w + GLYPH_PADDING > ATLAS_SIZE) {
+		mPenX = 0;
+		mPenY += mShelfHeight;
+		mShelfHeight = 0;
+	}
+	if (rendered->w + GLYPH_PADDING > ATLAS_SIZE
+			|| mPenY + rendered->h + GLYPH_PADDING > ATLAS_SIZE) {
+		SDL_Log("Glyph atlas is full");
+		SDL_FreeSurface(rendered);
+		return g;
+	}
+	g.source = { mPenX, mPenY, rendered->w, rendered->h };
+	// copy the glyph's alpha rather than blending it onto the clear atlas
+	SDL_SetSurfaceBlendMode(rendered, SDL_BLENDMODE_NONE);
+	SDL_Rect dest = g.source;
+	SDL_BlitSurface(rendered, nullptr, mAtlas, &dest);
+	SDL_FreeSurface(rendered);
+
+	if (mDirtyBottom == mDirtyTop) {
+		mDirtyTop = g.source.y;
+		mDirtyBottom = g.source.y + g.source.h;
+	} else {
+		mDirtyTop = std::min(mDirtyTop, g.source.y);
+		mDirtyBottom = std::max(mDirtyBottom, g.source.y + g.source.h);
+	}
+	mPenX += g.source.w + GLYPH_PADDING;
+	mShelfHeight = std::max(mShelfHeight, g.source.h + GLYPH_PADDING);
+	return g;
+}
+
+void TextRenderer::upload() {
+	if (mDirtyBottom == mDirtyTop) {
+		return;
+	}
+	SDL_Rect rows = { 0, mDirtyTop, ATLAS_SIZE, mDirtyBottom - mDirtyTop };
+	const Uint8 *pixels = static_cast<const Uint8*>(mAtlas->pixels)
+			+ mDirtyTop * mAtlas->pitch;
+	SDL_UpdateTexture(mTexture, &rows, pixels, mAtlas->pitch);
+	mDirtyTop = mDirtyBottom = 0;
+}
+
+TextRenderer::Label::Label(TextRenderer &text) :
+		mOwner(&text) {
+	mColor = { 255, 255, 255, 255 };
+}
+
+void TextRenderer::Label::setText(const char *text) {
+	if (mText == text) {
+		return;
+	}
+	mText = text;
+	mDirty = true;
+}
+
+void TextRenderer::Label::setColor(SDL_Color color) {
+	if (color.r == mColor.r && color.g == mColor.g && color.b == mColor.b
+			&& color.a == mColor.a) {
+		return;
+	}
+	mColor = color;
+	mDirty = true;
+}
+
+int TextRenderer::Label::width() {
+	if (mDirty) {
+		layOut();
+	}
+	return mWidth;
+}
+
+void TextRenderer::Label::layOut() {
+	mDirty = false;
+	mWidth = 0;
+	mSource.clear();
+	mDest.clear();
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+	mPlaced = false;
+#endif
+	if (!mOwner->isLoaded()) {
+		return;
+	}
+	int pen = 0;
+	const char *text = mText.c_str();
+	while (*text != '\0') {
+		const Glyph &g = mOwner->glyph(nextCharacter(text));
+		if (g.source.w > 0) {
+			mSource.push_back(g.source);
+			SDL_Rect dest = { pen, 0, g.source.w, g.source.h };
+			mDest.push_back(dest);
+		}
+		pen += g.advance;
+	}
+	mWidth = pen;
+}
+
+// With SDL_RenderGeometry the text is one draw call of two triangles per
+// glyph; older SDL copies the glyphs one at a time
+void TextRenderer::Label::draw(int x, int y) {
+	if (!mOwner->isLoaded()) {
+		return;
+	}
+	if (mDirty) {
+		layOut();
+	}
+	mOwner->upload();
+	if (mSource.empty()) {
+		return;
+	}
+
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+	if (!mPlaced || x != mX || y != mY) {
+		const float scale = 1.0f / ATLAS_SIZE;
+		mVertices.clear();
+		mIndices.clear();
+		for (std::size_t i = 0; i < mSource.size(); i++) {
+			const SDL_Rect &s = mSource[i];
+			const SDL_Rect &d = mDest[i];
+			int first = static_cast<int>(mVertices.size());
+			for (int corner = 0; corner < 4; corner++) {
+				int right = corner & 1;
+				int bottom = corner >> 1;
+				SDL_Vertex v;
+				v.position.x = float(x + d.x + right * d.w);
+				v.position.y = float(y + d.y + bottom * d.h);
+				v.color = mColor;
+				v.tex_coord.x = (s.x + right * s.w) * scale;
+				v.tex_coord.y = (s.y + bottom * s.h) * scale;
+				mVertices.push_back(v);
+			}
+			const int corners[] = { 0, 1, 2, 2, 1, 3 };
+			for (int corner : corners) {
+				mIndices.push_back(first + corner);
+			}
+		}
+		mX = x;
+		mY = y;
+		mPlaced = true;
+	}
+	SDL_RenderGeometry(mOwner->mRenderer, mOwner->mTexture, mVertices.data(),
+			static_cast<int>(mVertices.size()), mIndices.data(),
+			static_cast<int>(mIndices.size()));
+#else
+	SDL_SetTextureColorMod(mOwner->mTexture, mColor.r, mColor.g, mColor.b);
+	SDL_SetTextureAlphaMod(mOwner->mTexture, mColor.a);
+	for (std::size_t i = 0; i < mSource.size(); i++) {
+		SDL_Rect dest = mDest[i];
+		dest.x += x;
+		dest.y += y;
+		SDL_RenderCopy(mOwner->mRenderer, mOwner->mTexture, &mSource[i], &dest);
+	}
+	mX = x;
+	mY = y;
+#endif
+}
@@ -0,0 +1,108 @@
+#ifndef BASE_TEXT_RENDERER
+#define BASE_TEXT_RENDERER
+
+#include <SDL.h>
+#include <SDL_ttf.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+//! \brief Draws text in one font and size from a texture atlas of its
+//! glyphs, so strings need no font opened or texture made to draw them.
+//!
+//! A glyph is rendered with SDL_ttf the first time a string uses it and
+//! packed into the atlas; the atlas texture is updated before the next draw
+//! that needs it.  Strings are drawn through Labels, which keep the quads
+//! of their text and lay it out again only when the text changes.  Glyphs
+//! are placed by their advances, without kerning.
+class TextRenderer {
+public:
+
+	static const int ATLAS_SIZE = 1024; //!< Width and height of the atlas, in pixels.
+
+	/**
+	 * @param SDL_Renderer* renderer: the renderer to draw with, or NULL
+	 * to draw nothing, as in a headless run
+	 * @param const std::string& fontFile: the font, under res
+	 * @param int fontSize: its point size
+	 */
+	TextRenderer(SDL_Renderer *renderer, const std::string &fontFile,
+			int fontSize);
+	~TextRenderer();
+
+	inline bool isLoaded() const { return mFont != nullptr && mAtlas != nullptr; } //!< Whether there is anything to draw with.
+	inline int lineHeight() const { return mLineHeight; }
+
+	//! \brief A string laid out in a TextRenderer's font, drawn as one
+	//! batch of quads from the atlas.
+	class Label {
+	public:
+
+		Label(TextRenderer &text);
+
+		/**
+		 * Set the text, laying it out again if it differs from what the
+		 * label holds
+		 * @param const char* text: UTF-8
+		 */
+		void setText(const char *text);
+		inline void setText(const std::string &text) { setText(text.c_str()); }
+		inline const std::string &text() const { return mText; }
+
+		void setColor(SDL_Color color);
+
+		int width(); //!< Width of the laid out text, in pixels.
+
+		void draw(int x, int y); //!< Draw with the text's top left at x, y.
+
+	private:
+
+		void layOut();
+
+		TextRenderer *mOwner;
+		std::string mText;
+		SDL_Color mColor;
+		bool mDirty = true; // text or colour changed since the last layout
+		int mWidth = 0;
+		int mX = 0;
+		int mY = 0;
+		std::vector<SDL_Rect> mSource; // per glyph, in the atlas
+		std::vector<SDL_Rect> mDest; // per glyph, relative to the text's top left
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+		std::vector<SDL_Vertex> mVertices;
+		std::vector<int> mIndices;
+		bool mPlaced = false; // mVertices are at mX, mY
+#endif
+	};
+
+private:
+
+	TextRenderer(const TextRenderer&) = delete;
+	void operator=(TextRenderer const&) = delete;
+
+	//! Where a glyph is in the atlas.
+	struct Glyph {
+		SDL_Rect source; //!< Empty for glyphs with nothing to draw or no room.
+		int advance;
+	};
+
+	const Glyph &glyph(Uint16 ch); // rendering and packing it the first time
+	void upload(); // copy newly packed glyphs to the atlas texture
+
+	SDL_Renderer *mRenderer;
+	TTF_Font *mFont = nullptr;
+	int mLineHeight = 0;
+	SDL_Surface *mAtlas = nullptr;
+	SDL_Texture *mTexture = nullptr;
+	std::unordered_map<Uint16, Glyph> mGlyphs;
+
+	// the shelf being packed, and the rows of the atlas not yet uploaded
+	int mPenX = 0;
+	int mPenY = 0;
+	int mShelfHeight = 0;
+	int mDirtyTop = 0;
+	int mDirtyBottom = 0;
+
+};
+
+#endif
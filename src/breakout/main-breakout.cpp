@@ -9,6 +9,7 @@
 #include "base/PatrolComponent.hpp"
 #include "base/PhysicsManager.hpp"
 #include "base/SDLGraphicsProgram.hpp"
+#include "base/HeadlessProgram.hpp"
 #include "base/ResourceManager.hpp"
 #include <SDL.h>
 #include <SDL_mixer.h>
@@ -31,8 +32,13 @@ int channel;
 class BreakoutInputComponent: public GenericComponent {
 public:
 
+	static const int PHASE = PHASE_INPUT; //!< Move the paddle before the ball reacts to it.
+	static const unsigned READS = ACCESS_OWNER | ACCESS_INPUT;
+	static const unsigned WRITES = ACCESS_OWNER;
+
 	BreakoutInputComponent(GameObject &gameObject, float speed) :
 			GenericComponent(gameObject), mSpeed(speed) {
+		setCollisionTags(NO_TAGS);
 	}
 
 	virtual void update(Level &level) override
@@ -41,7 +47,7 @@ public:
 		bool right = InputManager::getInstance().isKeyDown(SDLK_RIGHT);
 
 		GameObject &gameObject = getGameObject();
-		std::shared_ptr<PhysicsComponent> pc = gameObject.physicsComponent();
+		PhysicsComponent *pc = gameObject.physicsComponent().get();
 
 		if (left && !right) {
 			pc->setVx(-mSpeed);
@@ -116,15 +122,13 @@ public:
 		collideSound = collide;
 	}
 
-	virtual void collision(Level &level, std::shared_ptr<GameObject> obj)
-			override {
+	virtual void collision(Level &level, GameObject &obj) override {
 		channel = Mix_PlayChannel(-1, collideSound, 0);
-		if (obj->tag() == 1) {
-			float xPos = obj->x() + (obj->w() / 2);
-			float yPos = obj->y() + obj->h();
+		if (obj.tag() == 1) {
+			float xPos = obj.x() + (obj.w() / 2);
+			float yPos = obj.y() + obj.h();
 			GameObject &gameObject = getGameObject();
-			std::shared_ptr<PhysicsComponent> pc =
-					gameObject.physicsComponent();
+			PhysicsComponent *pc = gameObject.physicsComponent().get();
 			b2Body *body = pc->getBody();
 			b2Vec2 bodyPos = body->GetPosition();
 			float xDir = xPos - bodyPos.x;
@@ -167,6 +171,7 @@ class Block: public GameObject {
 public:
 	Block(Level &level, float x, float y) :
 			GameObject(level, x, y, SIZE * 0.9, SIZE * 0.7, TAG_BLOCK) {
+		setStatic(true);
 		setPhysicsComponent(
 				std::make_shared < PhysicsComponent
 						> (*this, PhysicsComponent::Type::STATIC_SOLID));
@@ -214,7 +219,7 @@ public:
 					std::make_shared < Ball
 							> (*this, position.first * SIZE, position.second
 									* SIZE, levelSounds);
-			std::shared_ptr<PhysicsComponent> pc = ball->physicsComponent();
+			PhysicsComponent *pc = ball->physicsComponent().get();
 			pc->setVx(ballSpeed);
 			pc->setVy(ballSpeed);
 			addObject(ball);
@@ -270,20 +275,30 @@ private:
 
 int main(int argc, char **argv) {
 
-	//Initialize SDL_mixer
-	if (Mix_OpenAudio(44100, MIX_DEFAULT_FORMAT, 2, 2048) < 0) {
+	// --headless runs the levels with no window, e.g. for soak tests
+	RunOptions options = RunOptions::parse(argc, argv);
+
+	//Initialize SDL_mixer; headless runs play nothing, so open no device
+	if (!options.headless
+			&& Mix_OpenAudio(44100, MIX_DEFAULT_FORMAT, 2, 2048) < 0) {
 		printf("SDL_mixer could not initialize! SDL_mixer Error: %s\n",
 				Mix_GetError());
 	}
 
 	ResourceManager::getInstance().startUp();
-	ResourceManager::getInstance().loadLevel("/Levels/Breakout/level1.txt");
-	ResourceManager::getInstance().loadLevel("/Levels/Breakout/level2.txt");
-	ResourceManager::getInstance().loadLevel("/Levels/Breakout/level3.txt");
-
-	ResourceManager::getInstance().loadMissEffect("Sounds/Death.wav");
-	ResourceManager::getInstance().loadBGM("Sounds/Breakout.wav");
-	ResourceManager::getInstance().loadCollisionEffect("Sounds/Bounce.wav");
+	// assets packed by bin/packer (make pack) are read from the archive
+	ResourceManager::getInstance().openArchive("assets.pak");
+	ResourceManager::getInstance().loadLevelAsync("/Levels/Breakout/level1.txt");
+	ResourceManager::getInstance().loadLevelAsync("/Levels/Breakout/level2.txt");
+	ResourceManager::getInstance().loadLevelAsync("/Levels/Breakout/level3.txt");
+
+	ResourceManager::getInstance().loadEffectAsync("Sounds/Death.wav",
+			&ResourceManager::missEff);
+	ResourceManager::getInstance().loadBGMAsync("Sounds/Breakout.wav");
+	ResourceManager::getInstance().loadEffectAsync("Sounds/Bounce.wav",
+			&ResourceManager::collEff);
+	// the files above load side by side on loader threads; this waits
+	ResourceManager::getInstance().finishLoading();
 
 	std::vector<Mix_Chunk*> soundVector;
 
@@ -310,8 +325,20 @@ int main(int argc, char **argv) {
 	levels.push_back(firstLevel);
 	levels.push_back(secondLevel);
 	levels.push_back(thirdLevel);
-	SDLGraphicsProgram mySDLGraphicsProgram(levels, GAME_ID);
-	mySDLGraphicsProgram.loop();
+	int status = 0;
+	if (options.headless) {
+		HeadlessProgram headlessProgram(levels, options);
+		if (!headlessProgram.run()) {
+			status = 1;
+		}
+	} else {
+		SDLGraphicsProgram mySDLGraphicsProgram(levels, GAME_ID);
+		if (!options.record.empty()) {
+			mySDLGraphicsProgram.recordInput(options.record);
+		}
+		mySDLGraphicsProgram.setPipelined(options.pipelined);
+		mySDLGraphicsProgram.loop();
+	}
 	ResourceManager::getInstance().shutDown();
-	return 0;
+	return status;
 }
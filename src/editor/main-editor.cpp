@@ -34,8 +34,11 @@ const float SIZE = 40.0f;
  */
 class EditorInputComponent: public GenericComponent {
 public:
+	static const int PHASE = PHASE_INPUT;
+
 	EditorInputComponent(GameObject &gameObject) :
 			GenericComponent(gameObject) {
+		setCollisionTags(NO_TAGS);
 	}
 
 	virtual void update(Level &level) override
@@ -112,11 +115,11 @@ public:
 class EditorPlayer: public GameObject {
 public:
 	EditorPlayer(Level &level, float x, float y,
-			std::vector<SDL_Texture*> playerTextures) :
+			std::vector<Sprite> playerSprites) :
 			GameObject(level, x, y, SIZE, SIZE, TAG_PLAYER) {
 		setRenderComponent(
 				std::make_shared < SpriteRenderComponent
-						> (*this, playerTextures));
+						> (*this, playerSprites));
 	}
 };
 
@@ -126,10 +129,10 @@ public:
 class EditorInvadersPlayer: public GameObject {
 public:
 	EditorInvadersPlayer(Level &level, float x, float y,
-			std::vector<SDL_Texture*> playerTextures) :
+			std::vector<Sprite> playerSprites) :
 			GameObject(level, x, y, SIZE * 1.5, SIZE * 1.5, TAG_PLAYER) {
-		std::vector<SDL_Texture*> tex;
-		tex.push_back(playerTextures[4]);
+		std::vector<Sprite> tex;
+		tex.push_back(playerSprites[4]);
 		setRenderComponent(
 				std::make_shared < SpriteRenderComponent > (*this, tex));
 	}
@@ -155,11 +158,11 @@ public:
 class EditorBlock: public GameObject {
 public:
 	EditorBlock(Level &level, float x, float y,
-			std::vector<SDL_Texture*> blockTextures) :
+			std::vector<Sprite> blockSprites) :
 			GameObject(level, x, y, SIZE, SIZE, TAG_BLOCK) {
 		setRenderComponent(
 				std::make_shared < SpriteRenderComponent
-						> (*this, blockTextures));
+						> (*this, blockSprites));
 	}
 };
 
@@ -181,12 +184,12 @@ public:
 class EditorEnemy: public GameObject {
 public:
 	EditorEnemy(Level &level, float x, float y,
-			std::vector<SDL_Texture*> enemyTextures) :
+			std::vector<Sprite> enemySprites) :
 			GameObject(level, x, y, SIZE, SIZE, TAG_ENEMY) {
 		if (editorGameId == 3) {
 			setRenderComponent(
 					std::make_shared < SpriteRenderComponent
-							> (*this, enemyTextures));
+							> (*this, enemySprites));
 		} else {
 			setRenderComponent(
 					std::make_shared < RectRenderComponent
@@ -203,11 +206,11 @@ public:
 class EditorCollectible: public GameObject {
 public:
 	EditorCollectible(Level &level, float x, float y,
-			std::vector<SDL_Texture*> collectibleTextures) :
+			std::vector<Sprite> collectibleSprites) :
 			GameObject(level, x, y, SIZE, SIZE, TAG_COLLECTIBLE) {
 		setRenderComponent(
 				std::make_shared < SpriteRenderComponent
-						> (*this, collectibleTextures));
+						> (*this, collectibleSprites));
 	}
 };
 
@@ -261,11 +264,11 @@ public:
 				if (editorGameId == 1) {
 					player = std::make_shared < EditorPlayer
 							> (*this, position.first * SIZE, position.second
-									* SIZE, playerTextures);
+									* SIZE, playerSprites);
 				} else if (editorGameId == 3) {
 					player = std::make_shared < EditorInvadersPlayer
 							> (*this, position.first * SIZE, position.second
-									* SIZE, playerTextures);
+									* SIZE, playerSprites);
 				}
 				setPlayer(player);
 				addObject(player);
@@ -294,7 +297,7 @@ public:
 				addObject(
 						std::make_shared < EditorBlock
 								> (*this, position.first * SIZE, position.second
-										* SIZE, blockTextures));
+										* SIZE, blockSprites));
 			} else if (editorGameId == 2) {
 				addObject(
 						std::make_shared < EditorBreakoutBlock
@@ -309,7 +312,7 @@ public:
 			addObject(
 					std::make_shared < EditorEnemy
 							> (*this, position.first * SIZE, position.second
-									* SIZE, enemyTextures));
+									* SIZE, enemySprites));
 			break;
 		}
 		case TAG_COLLECTIBLE: // A collectible object to be created in the scene
@@ -317,7 +320,7 @@ public:
 			addObject(
 					std::make_shared < EditorCollectible
 							> (*this, position.first * SIZE, position.second
-									* SIZE, collectibleTextures));
+									* SIZE, collectibleSprites));
 			break;
 		}
 		case TAG_SHIELD:
@@ -334,48 +337,35 @@ public:
 	void initialize(SDL_Renderer *renderer) override
 	{
 		finalize();
+
+		// every sprite is a region of the atlas packed at load time, whose
+		// texture is made once and shared by the levels
+		const SpriteAtlas &atlas = ResourceManager::getInstance().spriteAtlas;
+		atlasTexture = ResourceManager::getInstance().getSpriteAtlasTexture(
+				renderer);
+		playerSprites.clear();
+		blockSprites.clear();
+		collectibleSprites.clear();
+		enemySprites.clear();
 		for (size_t i = 0; i < 5; i++) {
-			SDL_Texture *newTexture = SDL_CreateTextureFromSurface(renderer,
-					levelSurfaces[i]);
-			if (newTexture == NULL) {
-				SDL_Log("Failed to create texture");
-			} else {
-				SDL_Log("Loaded texture");
-			}
+			Sprite sprite = atlas.sprite(atlasTexture->texture, levelSurfaces[i]);
 			//Get rid of old loaded surface
 			//SDL_FreeSurface(levelSurfaces[i]);
-			playerTextures.push_back(newTexture);
+			playerSprites.push_back(sprite);
 		}
 
-		SDL_Texture *block = SDL_CreateTextureFromSurface(renderer,
-				levelSurfaces[5]);
-		if (block == NULL) {
-			SDL_Log("Failed to create texture");
-		} else {
-			SDL_Log("Loaded texture");
-		}
+		Sprite block = atlas.sprite(atlasTexture->texture, levelSurfaces[5]);
 		//Get rid of old loaded surface
 		//SDL_FreeSurface(levelSurfaces[4]);
-		blockTextures.push_back(block);
+		blockSprites.push_back(block);
 
-		SDL_Texture *collectibleTexture = SDL_CreateTextureFromSurface(renderer,
+		Sprite collectible = atlas.sprite(atlasTexture->texture,
 				levelSurfaces[6]);
-		if (block == NULL) {
-			SDL_Log("Failed to create texture");
-		} else {
-			SDL_Log("Loaded texture");
-		}
-		collectibleTextures.push_back(collectibleTexture);
+		collectibleSprites.push_back(collectible);
 
 		for (int i = 7; i < 9; i++) {
-			SDL_Texture *newTexture = SDL_CreateTextureFromSurface(renderer,
-					levelSurfaces[i]);
-			if (block == NULL) {
-				SDL_Log("Failed to create texture");
-			} else {
-				SDL_Log("Loaded texture");
-			}
-			enemyTextures.push_back(newTexture);
+			Sprite sprite = atlas.sprite(atlasTexture->texture, levelSurfaces[i]);
+			enemySprites.push_back(sprite);
 		}
 
 		float xPos = 0;
@@ -427,24 +417,28 @@ public:
 private:
 	std::vector<std::string> levelLayout;
 	std::vector<SDL_Surface*> levelSurfaces;
-	std::vector<SDL_Texture*> playerTextures;
-	std::vector<SDL_Texture*> blockTextures;
-	std::vector<SDL_Texture*> collectibleTextures;
-	std::vector<SDL_Texture*> enemyTextures;
+	std::vector<Sprite> playerSprites;
+	std::vector<Sprite> blockSprites;
+	std::vector<Sprite> collectibleSprites;
+	std::vector<Sprite> enemySprites;
+	TextureHandle atlasTexture;
 };
 
 void loadResources() {
 	ResourceManager::getInstance().startUp();
-	ResourceManager::getInstance().loadLevel(filename);
-	ResourceManager::getInstance().loadSurface("Sprites/slime.png");
-	ResourceManager::getInstance().loadSurface("Sprites/slimeleft.png");
-	ResourceManager::getInstance().loadSurface("Sprites/slimejump.png");
-	ResourceManager::getInstance().loadSurface("Sprites/slimejumpleft.png");
-	ResourceManager::getInstance().loadSurface("Sprites/ship.png");
-	ResourceManager::getInstance().loadSurface("Sprites/tile.png");
-	ResourceManager::getInstance().loadSurface("Sprites/collectible.png");
-	ResourceManager::getInstance().loadSurface("Sprites/enemy1.png");
-	ResourceManager::getInstance().loadSurface("Sprites/enemy2.png");
+	ResourceManager::getInstance().loadLevelAsync(filename);
+	ResourceManager::getInstance().loadSurfaceAsync("Sprites/slime.png");
+	ResourceManager::getInstance().loadSurfaceAsync("Sprites/slimeleft.png");
+	ResourceManager::getInstance().loadSurfaceAsync("Sprites/slimejump.png");
+	ResourceManager::getInstance().loadSurfaceAsync("Sprites/slimejumpleft.png");
+	ResourceManager::getInstance().loadSurfaceAsync("Sprites/ship.png");
+	ResourceManager::getInstance().loadSurfaceAsync("Sprites/tile.png");
+	ResourceManager::getInstance().loadSurfaceAsync("Sprites/collectible.png");
+	ResourceManager::getInstance().loadSurfaceAsync("Sprites/enemy1.png");
+	ResourceManager::getInstance().loadSurfaceAsync("Sprites/enemy2.png");
+	// the files above load side by side on loader threads; this waits
+	ResourceManager::getInstance().finishLoading();
+	ResourceManager::getInstance().packSprites();
 }
 
 int main(int argc, char **argv) {
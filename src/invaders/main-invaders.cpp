@@ -9,6 +9,7 @@
 #include "base/PatrolComponent.hpp"
 #include "base/PhysicsManager.hpp"
 #include "base/SDLGraphicsProgram.hpp"
+#include "base/HeadlessProgram.hpp"
 #include "base/ResourceManager.hpp"
 #include "base/LTimer.hpp"
 #include <SDL.h>
@@ -26,10 +27,14 @@ static const int TAG_ENEMY_PROJ = 10;
 static const int TAG_SHIELD = 11;
 static const int TAG_SPEEDUP = 12;
 static const int TAG_HEALTHUP = 13;
+static const int TAG_BOTTOM = 14;
 
 //tells the SDLGraphicsProgram which game is being run
 static const int GAME_ID = 3;
 
+//shots are drawn over the ships, shields and power ups in layer 0
+static const Uint8 LAYER_SHOTS = 1;
+
 int channel;
 
 /**
@@ -40,16 +45,25 @@ public:
 	EnemyProjectile(Level &level, float x, float y, Mix_Chunk *deathSound) :
 			GameObject(level, x, y, SIZE * 0.25, SIZE * 0.25, TAG_ENEMY_PROJ) {
 		setPhysicsComponent(
-				std::make_shared < PhysicsComponent
+				makePooled < PhysicsComponent
 						> (*this, PhysicsComponent::Type::DYNAMIC_SOLID));
 		setRenderComponent(
-				std::make_shared < RectRenderComponent
+				makePooled < RectRenderComponent
 						> (*this, 0xff, 0x00, 0x00));
+		renderComponent()->setLayer(LAYER_SHOTS);
 		physicsComponent()->setVy(300);
 		addGenericComponent(
-				std::make_shared < RemoveOnCollideComponent
+				makePooled < RemoveOnCollideComponent
 						> (*this, TAG_ENEMY_PROJ, nullptr, channel));
 	}
+
+	// called by Level::spawn when a pooled shot is fired again
+	void respawn(float x, float y, Mix_Chunk *deathSound) {
+		setX(x);
+		setY(y);
+		physicsComponent()->reset();
+		physicsComponent()->setVy(300);
+	}
 };
 
 /**
@@ -60,16 +74,25 @@ public:
 	Projectile(Level &level, float x, float y, Mix_Chunk *deathSound) :
 			GameObject(level, x, y, SIZE * 0.25, SIZE * 0.25, TAG_PROJECTILE) {
 		setPhysicsComponent(
-				std::make_shared < PhysicsComponent
+				makePooled < PhysicsComponent
 						> (*this, PhysicsComponent::Type::DYNAMIC_SOLID));
 		setRenderComponent(
-				std::make_shared < RectRenderComponent
+				makePooled < RectRenderComponent
 						> (*this, 0xff, 0x00, 0x00));
+		renderComponent()->setLayer(LAYER_SHOTS);
 		physicsComponent()->setVy(-600);
 		addGenericComponent(
-				std::make_shared < RemoveOnCollideComponent
+				makePooled < RemoveOnCollideComponent
 						> (*this, TAG_ENEMY_PROJ, nullptr, channel));
 	}
+
+	// called by Level::spawn when a pooled shot is fired again
+	void respawn(float x, float y, Mix_Chunk *deathSound) {
+		setX(x);
+		setY(y);
+		physicsComponent()->reset();
+		physicsComponent()->setVy(-600);
+	}
 };
 
 /**
@@ -80,11 +103,11 @@ public:
 
 	PowerUpComponent(GameObject &gameObject, int powerUpType) :
 			GenericComponent(gameObject), mPowerUpType(powerUpType) {
+		setCollisionTags(tagBit(TAG_PLAYER));
 	}
 
-	virtual void collision(Level &level, std::shared_ptr<GameObject> obj)
-			override {
-		if (obj->tag() == TAG_PLAYER) {
+	virtual void collision(Level &level, GameObject &obj) override {
+		if (obj.tag() == TAG_PLAYER) {
 
 			if (mPowerUpType == 1) {
 				level.restoreHealth();
@@ -136,16 +159,17 @@ public:
 
 	HealthComponent(GameObject &gameObject, int health, int tag) :
 			GenericComponent(gameObject), mHealth(health), enemyTag(tag) {
+		setCollisionTags(tagBit(tag));
 	}
 
-	virtual void collision(Level &level, std::shared_ptr<GameObject> obj)
-			override {
-		if (obj->tag() == enemyTag) {
+	virtual void collision(Level &level, GameObject &obj) override {
+		if (obj.tag() == enemyTag) {
 			mHealth--;
 			if (mHealth == 0) {
-				GameObject &gameObject = getGameObject();
-				gameObject.setPhysicsComponent(nullptr);
-				//level.removeObject(gameObject.shared_from_this());
+				// removed rather than stripped of its body: destroying the
+				// body here would free the contact being reported, and the
+				// level only sees a lost player or a cleared wave on removal
+				level.removeObject(getGameObject());
 			}
 		}
 	}
@@ -164,9 +188,13 @@ private:
  */
 class InvadersInputComponent: public GenericComponent {
 public:
+	static const int PHASE = PHASE_INPUT;
+
 	InvadersInputComponent(GameObject &gameObject, float speed,
 			Mix_Chunk *shootSound) :
-			GenericComponent(gameObject), mSpeed(speed) {
+			GenericComponent(gameObject), mSpeed(speed), playerTimer(
+					LTimer::SIMULATION_TIME) {
+		setCollisionTags(NO_TAGS);
 		sound = shootSound;
 		playerTimer.start();
 		shootTime = 400;
@@ -181,7 +209,7 @@ public:
 		bool space = InputManager::getInstance().isKeyDown(SDLK_SPACE);
 
 		GameObject &gameObject = getGameObject();
-		std::shared_ptr<PhysicsComponent> pc = gameObject.physicsComponent();
+		PhysicsComponent *pc = gameObject.physicsComponent().get();
 
 		if (level.isSpedUp()) {
 			powerUpTime = 400;
@@ -208,11 +236,8 @@ public:
 		if (space) {
 			if (playerTimer.getTicks() > nextShot) {
 				nextShot = playerTimer.getTicks() + shootTime;
-				auto shot =
-						std::make_shared < Projectile
-								> (level, gameObject.x() + (gameObject.w() / 2)
-										- 5, gameObject.y(), sound);
-				level.addObject(shot);
+				level.spawn < Projectile
+						> (gameObject.x() + (gameObject.w() / 2) - 5, gameObject.y(), sound);
 			}
 		}
 
@@ -258,13 +283,30 @@ public:
 	}
 };
 
+/**
+ * Sits just below the screen and takes away enemy shots that miss, which
+ * would otherwise fall for the rest of the level
+ */
+class BottomWall: public GameObject {
+public:
+	BottomWall(Level &level, float x, float y) :
+			GameObject(level, x, y, SIZE * 20, 1, TAG_BOTTOM) {
+		setPhysicsComponent(
+				std::make_shared < PhysicsComponent
+						> (*this, PhysicsComponent::Type::STATIC_SOLID));
+		addGenericComponent(
+				std::make_shared < RemoveOnCollideComponent
+						> (*this, TAG_ENEMY_PROJ, nullptr, channel));
+	}
+};
+
 /**
  * Represents the player
  */
 class InvadersPlayer: public GameObject {
 public:
 	InvadersPlayer(Level &level, float x, float y,
-			std::vector<SDL_Texture*> playerTextures, Mix_Chunk *shootSound) :
+			std::vector<Sprite> playerSprites, Mix_Chunk *shootSound) :
 			GameObject(level, x, y, SIZE * 1.5, SIZE * 1.5, TAG_PLAYER) {
 		addGenericComponent(
 				std::make_shared < InvadersInputComponent
@@ -274,7 +316,7 @@ public:
 						> (*this, PhysicsComponent::Type::DYNAMIC_SOLID));
 		setRenderComponent(
 				std::make_shared < SpriteRenderComponent
-						> (*this, playerTextures));
+						> (*this, playerSprites));
 		addGenericComponent(
 				std::make_shared < RemoveOnCollideComponent
 						> (*this, TAG_HEALTHUP, nullptr, channel));
@@ -293,7 +335,8 @@ public:
 class EnemyControlComponent: public GenericComponent {
 public:
 	EnemyControlComponent(GameObject &gameObject, Mix_Chunk *shootSound, int id) :
-			GenericComponent(gameObject) {
+			GenericComponent(gameObject), enemyTimer(LTimer::SIMULATION_TIME) {
+		setCollisionTags(NO_TAGS);
 		sound = shootSound;
 		enemyTimer.start();
 		shootTime = 3000;
@@ -309,17 +352,14 @@ public:
 	virtual void update(Level &level) override
 	{
 		GameObject &gameObject = getGameObject();
-		std::shared_ptr<RenderComponent> rc = gameObject.renderComponent();
-		std::shared_ptr<SpriteRenderComponent> spriteComponent =
-				std::static_pointer_cast < SpriteRenderComponent > (rc);
+		SpriteRenderComponent *spriteComponent =
+				static_cast<SpriteRenderComponent*>(gameObject.renderComponent().get());
 
 		if (enemyTimer.getTicks() > nextShot) {
 			nextShot = enemyTimer.getTicks() + shootTime;
-			auto shot =
-					std::make_shared < EnemyProjectile
-							> (level, gameObject.x() + (gameObject.w() / 2) - 5, gameObject.y()
-									+ gameObject.h(), sound);
-			level.addObject(shot);
+			level.spawn < EnemyProjectile
+					> (gameObject.x() + (gameObject.w() / 2) - 5, gameObject.y()
+							+ gameObject.h(), sound);
 		}
 
 		if (enemyTimer.getTicks() > nextSpriteSwitch) {
@@ -349,7 +389,7 @@ private:
 class SpaceEnemy: public GameObject {
 public:
 	SpaceEnemy(Level &level, float x, float y, float distX, float distY,
-			std::vector<SDL_Texture*> enemyTextures, Mix_Chunk *deathSound,
+			std::vector<Sprite> enemySprites, Mix_Chunk *deathSound,
 			int enemyId) :
 			GameObject(level, x, y, SIZE, SIZE, TAG_ENEMY) {
 		addGenericComponent(
@@ -360,7 +400,7 @@ public:
 						> (*this, PhysicsComponent::Type::DYNAMIC_SOLID));
 		setRenderComponent(
 				std::make_shared < SpriteRenderComponent
-						> (*this, enemyTextures));
+						> (*this, enemySprites));
 		addGenericComponent(
 				std::make_shared < PatrolComponent
 						> (*this, x + distX, y + distY, SIZE * 2));
@@ -409,6 +449,8 @@ public:
 	InvadersLevel(std::vector<std::string> layout,
 			std::vector<SDL_Surface*> surfaces, std::vector<Mix_Chunk*> sounds) :
 			Level(20 * SIZE, 20 * SIZE, false, GAME_ID) {
+		// projectiles and enemies are numerous, so keep their data packed
+		useComponentStore(true);
 		levelLayout = layout;
 		levelSounds = sounds;
 		levelSurfaces = surfaces;
@@ -417,14 +459,9 @@ public:
 	//Restore health completely when obtaining a sheild
 	void restoreHealth() override
 	{
-		for (auto shield : shields) {
-			shield->mHealthComponent->setHealth(3);
-		}
-
-		for (std::shared_ptr<GameObject> shield : shields) {
-			std::shared_ptr<RenderComponent> rc = std::make_shared < RectRenderComponent
-					> (*shield, 0xFF, 0xFF, 0xFF);
-			shield->setRenderComponent(rc);
+		const std::vector<GameObject*> &shields = objectsWithTag(TAG_SHIELD);
+		for (auto object : shields) {
+			static_cast<Shield*>(object)->mHealthComponent->setHealth(3);
 		}
 	}
 
@@ -435,7 +472,7 @@ public:
 			auto player =
 					std::make_shared < InvadersPlayer
 							> (*this, position.first * SIZE, position.second
-									* SIZE, playerTextures, levelSounds[0]);
+									* SIZE, playerSprites, levelSounds[0]);
 			addObject(player);
 			break;
 		}
@@ -444,7 +481,7 @@ public:
 			auto enemy =
 					std::make_shared < SpaceEnemy
 							> (*this, position.first * SIZE, position.second
-									* SIZE, SIZE, 0, enemyTextures, levelSounds[0], numEnemies);
+									* SIZE, SIZE, 0, enemySprites, levelSounds[0], numEnemies);
 			addObject(enemy);
 			numEnemies++;
 
@@ -469,7 +506,6 @@ public:
 			auto shield = std::make_shared < Shield
 					> (*this, position.first * SIZE, position.second * SIZE);
 			addObject(shield);
-			shields.push_back(shield);
 			break;
 		}
 
@@ -495,24 +531,19 @@ public:
 	{
 		finalize();
 
-		SDL_Texture *player = SDL_CreateTextureFromSurface(renderer,
-				levelSurfaces[0]);
-		if (player == NULL) {
-			SDL_Log("Failed to create texture");
-		} else {
-			SDL_Log("Loaded texture");
-		}
-		playerTextures.push_back(player);
+		// every sprite is a region of the atlas packed at load time, whose
+		// texture is made once and shared by the levels
+		const SpriteAtlas &atlas = ResourceManager::getInstance().spriteAtlas;
+		atlasTexture = ResourceManager::getInstance().getSpriteAtlasTexture(
+				renderer);
+		playerSprites.clear();
+		enemySprites.clear();
+		Sprite player = atlas.sprite(atlasTexture->texture, levelSurfaces[0]);
+		playerSprites.push_back(player);
 
 		for (int i = 1; i < 3; i++) {
-			SDL_Texture *newTexture = SDL_CreateTextureFromSurface(renderer,
-					levelSurfaces[i]);
-			if (newTexture == NULL) {
-				SDL_Log("Failed to create texture");
-			} else {
-				SDL_Log("Loaded texture");
-			}
-			enemyTextures.push_back(newTexture);
+			Sprite sprite = atlas.sprite(atlasTexture->texture, levelSurfaces[i]);
+			enemySprites.push_back(sprite);
 		}
 
 		float xPos = 0;
@@ -545,22 +576,27 @@ public:
 		makeObject(TAG_TOP, std::make_pair(0, 0));
 		makeObject(TAG_SIDE, std::make_pair(0, 0));
 		makeObject(TAG_SIDE, std::make_pair(20, 0));
+		addObject(std::make_shared < BottomWall > (*this, 0, 20 * SIZE));
 	}
 
 private:
 	std::vector<std::string> levelLayout;
 	std::vector<Mix_Chunk*> levelSounds;
 	std::vector<SDL_Surface*> levelSurfaces;
-	std::vector<SDL_Texture*> playerTextures;
-	std::vector<SDL_Texture*> enemyTextures;
-	std::vector<std::shared_ptr<Shield>> shields;
+	std::vector<Sprite> playerSprites;
+	std::vector<Sprite> enemySprites;
+	TextureHandle atlasTexture;
 	int numEnemies = 0;
 };
 
 int main(int argc, char **argv) {
 
-	//Initialize SDL_mixer
-	if (Mix_OpenAudio(44100, MIX_DEFAULT_FORMAT, 2, 2048) < 0) {
+	// --headless runs the levels with no window, e.g. for soak tests
+	RunOptions options = RunOptions::parse(argc, argv);
+
+	//Initialize SDL_mixer; headless runs play nothing, so open no device
+	if (!options.headless
+			&& Mix_OpenAudio(44100, MIX_DEFAULT_FORMAT, 2, 2048) < 0) {
 		printf("SDL_mixer could not initialize! SDL_mixer Error: %s\n",
 				Mix_GetError());
 	}
@@ -570,19 +606,26 @@ int main(int argc, char **argv) {
 
 	//Resource loading
 	ResourceManager::getInstance().startUp();
-	ResourceManager::getInstance().loadSurface("Sprites/ship.png");
-	ResourceManager::getInstance().loadSurface("Sprites/enemy1.png");
-	ResourceManager::getInstance().loadSurface("Sprites/enemy2.png");
+	// assets packed by bin/packer (make pack) are read from the archive
+	ResourceManager::getInstance().openArchive("assets.pak");
+	ResourceManager::getInstance().loadSurfaceAsync("Sprites/ship.png");
+	ResourceManager::getInstance().loadSurfaceAsync("Sprites/enemy1.png");
+	ResourceManager::getInstance().loadSurfaceAsync("Sprites/enemy2.png");
+
+	ResourceManager::getInstance().loadLevelAsync("/Levels/Invaders/level1.txt");
+	ResourceManager::getInstance().loadLevelAsync("/Levels/Invaders/level2.txt");
+	ResourceManager::getInstance().loadLevelAsync("/Levels/Invaders/level3.txt");
+	//ResourceManager::getInstance().loadBGM("Sounds/Invaders.wav");
+	ResourceManager::getInstance().loadEffectAsync("Sounds/Death.wav",
+			&ResourceManager::missEff);
+	ResourceManager::getInstance().loadEffectAsync("Sounds/Bounce.wav",
+			&ResourceManager::collEff);
+	// the files above load side by side on loader threads; this waits
+	ResourceManager::getInstance().finishLoading();
+	ResourceManager::getInstance().packSprites();
 	std::vector<SDL_Surface*> surfaces =
 			ResourceManager::getInstance().getSurfaces();
 
-	ResourceManager::getInstance().loadLevel("/Levels/Invaders/level1.txt");
-	ResourceManager::getInstance().loadLevel("/Levels/Invaders/level2.txt");
-	ResourceManager::getInstance().loadLevel("/Levels/Invaders/level3.txt");
-	//ResourceManager::getInstance().loadBGM("Sounds/Invaders.wav");
-	ResourceManager::getInstance().loadMissEffect("Sounds/Death.wav");
-	ResourceManager::getInstance().loadCollisionEffect("Sounds/Bounce.wav");
-
 	std::vector<Mix_Chunk*> soundVector;
 	soundVector.push_back(ResourceManager::getInstance().missEff);
 	soundVector.push_back(ResourceManager::getInstance().collEff);
@@ -604,8 +647,20 @@ int main(int argc, char **argv) {
 	levels.push_back(firstLevel);
 	levels.push_back(secondLevel);
 	levels.push_back(thirdLevel);
-	SDLGraphicsProgram mySDLGraphicsProgram(levels, GAME_ID);
-	mySDLGraphicsProgram.loop();
+	int status = 0;
+	if (options.headless) {
+		HeadlessProgram headlessProgram(levels, options);
+		if (!headlessProgram.run()) {
+			status = 1;
+		}
+	} else {
+		SDLGraphicsProgram mySDLGraphicsProgram(levels, GAME_ID);
+		if (!options.record.empty()) {
+			mySDLGraphicsProgram.recordInput(options.record);
+		}
+		mySDLGraphicsProgram.setPipelined(options.pipelined);
+		mySDLGraphicsProgram.loop();
+	}
 	ResourceManager::getInstance().shutDown();
-	return 0;
+	return status;
 }
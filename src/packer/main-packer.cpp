@@ -0,0 +1,155 @@
+#include <SDL.h>
+#include <SDL_image.h>
+#include "base/AssetArchive.hpp"
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+// Packs assets into one archive for ResourceManager::openArchive:
+//
+//   main-packer OUTPUT ROOT [--raw] FILE...
+//
+// Each FILE is a path under ROOT, the resource directory, and is found
+// under that path at run time.  Images are decoded and converted to the
+// pixel format the renderers and the sprite atlas use; .wav sounds are
+// converted to the format the games open the mixer with; anything else,
+// and every file after --raw, is kept as it is.  Music is read by the
+// mixer as it plays, so music files go after --raw.
+
+namespace {
+
+// what the renderers take without converting, and the sprite atlas is in
+const Uint32 IMAGE_FORMAT = SDL_PIXELFORMAT_ARGB8888;
+
+// as the games pass to Mix_OpenAudio
+const int SOUND_FREQUENCY = 44100;
+const SDL_AudioFormat SOUND_FORMAT = AUDIO_S16SYS;
+const int SOUND_CHANNELS = 2;
+
+bool hasExtension(const std::string &name, const char *extension) {
+	std::size_t length = std::strlen(extension);
+	if (name.size() < length) {
+		return false;
+	}
+	for (std::size_t i = 0; i < length; i++) {
+		char c = name[name.size() - length + i];
+		if (c >= 'A' && c <= 'Z') {
+			c = c - 'A' + 'a';
+		}
+		if (c != extension[i]) {
+			return false;
+		}
+	}
+	return true;
+}
+
+bool addRaw(AssetArchive::Builder &builder, const std::string &name,
+		const std::string &path) {
+	std::ifstream in(path, std::ios::binary);
+	if (!in.is_open()) {
+		return false;
+	}
+	std::vector<char> bytes((std::istreambuf_iterator<char>(in)),
+			std::istreambuf_iterator<char>());
+	builder.add(name, AssetArchive::RAW, NULL, bytes.data(), bytes.size());
+	return true;
+}
+
+bool addImage(AssetArchive::Builder &builder, const std::string &name,
+		const std::string &path) {
+	SDL_Surface *loaded = IMG_Load(path.c_str());
+	if (loaded == NULL) {
+		return false;
+	}
+	SDL_Surface *converted = SDL_ConvertSurfaceFormat(loaded, IMAGE_FORMAT, 0);
+	SDL_FreeSurface(loaded);
+	if (converted == NULL) {
+		return false;
+	}
+	Uint32 params[4] = { Uint32(converted->w), Uint32(converted->h),
+			Uint32(converted->pitch), IMAGE_FORMAT };
+	SDL_LockSurface(converted);
+	builder.add(name, AssetArchive::IMAGE, params, converted->pixels,
+			std::size_t(converted->pitch) * converted->h);
+	SDL_UnlockSurface(converted);
+	SDL_FreeSurface(converted);
+	return true;
+}
+
+bool addSound(AssetArchive::Builder &builder, const std::string &name,
+		const std::string &path) {
+	SDL_AudioSpec spec;
+	Uint8 *samples = NULL;
+	Uint32 length = 0;
+	if (SDL_LoadWAV(path.c_str(), &spec, &samples, &length) == NULL) {
+		return false;
+	}
+	SDL_AudioCVT cvt;
+	if (SDL_BuildAudioCVT(&cvt, spec.format, spec.channels, spec.freq,
+			SOUND_FORMAT, SOUND_CHANNELS, SOUND_FREQUENCY) < 0) {
+		SDL_FreeWAV(samples);
+		return false;
+	}
+	std::vector<Uint8> buffer(std::size_t(length) * cvt.len_mult);
+	std::memcpy(buffer.data(), samples, length);
+	SDL_FreeWAV(samples);
+	cvt.buf = buffer.data();
+	cvt.len = length;
+	if (cvt.needed && SDL_ConvertAudio(&cvt) < 0) {
+		return false;
+	}
+	Uint32 params[4] = { Uint32(SOUND_FREQUENCY), SOUND_FORMAT,
+			Uint32(SOUND_CHANNELS), 0 };
+	builder.add(name, AssetArchive::SOUND, params, buffer.data(),
+			cvt.needed ? cvt.len_cvt : length);
+	return true;
+}
+
+}
+
+int main(int argc, char **argv) {
+	if (argc < 3) {
+		printf("usage: %s OUTPUT ROOT [--raw] FILE...\n", argv[0]);
+		return 1;
+	}
+	std::string output = argv[1];
+	std::string root = argv[2];
+	if (!root.empty() && root[root.size() - 1] != '/') {
+		root += '/';
+	}
+
+	AssetArchive::Builder builder;
+	bool raw = false;
+	int failed = 0;
+	for (int i = 3; i < argc; i++) {
+		std::string name = argv[i];
+		if (name == "--raw") {
+			raw = true;
+			continue;
+		}
+		std::string path = root + AssetArchive::normalize(name);
+		bool added;
+		if (!raw && (hasExtension(name, ".png") || hasExtension(name, ".bmp")
+				|| hasExtension(name, ".jpg"))) {
+			added = addImage(builder, name, path);
+		} else if (!raw && hasExtension(name, ".wav")) {
+			added = addSound(builder, name, path);
+		} else {
+			added = addRaw(builder, name, path);
+		}
+		if (!added) {
+			printf("Failed to pack %s: %s\n", path.c_str(), SDL_GetError());
+			failed++;
+		}
+	}
+
+	if (!builder.save(output)) {
+		printf("Failed to write %s\n", output.c_str());
+		return 1;
+	}
+	printf("Packed %d assets into %s\n", int(builder.count()), output.c_str());
+	return failed > 0 ? 1 : 0;
+}
@@ -14,6 +14,7 @@
 #include "base/PatrolComponent.hpp"
 #include "base/PhysicsManager.hpp"
 #include "base/SDLGraphicsProgram.hpp"
+#include "base/HeadlessProgram.hpp"
 #include "base/ResourceManager.hpp"
 #include <SDL.h>
 #include <SDL_mixer.h>
@@ -32,10 +33,13 @@ int channel;
 class JmpInputComponent: public GenericComponent {
 public:
 
+	static const int PHASE = PHASE_INPUT;
+
 	JmpInputComponent(GameObject &gameObject, float speed, float jump,
 			float gravity, Mix_Chunk *jumpSound) :
 			GenericComponent(gameObject), mSpeed(speed), mJump(jump), mGravity(
 					gravity) {
+		setCollisionTags(NO_TAGS);
 		jSound = jumpSound;
 	}
 
@@ -46,12 +50,11 @@ public:
 		bool jump = InputManager::getInstance().isKeyPressed(SDLK_UP);
 
 		GameObject &gameObject = getGameObject();
-		std::shared_ptr<PhysicsComponent> pc = gameObject.physicsComponent();
+		PhysicsComponent *pc = gameObject.physicsComponent().get();
 		b2Body *body = pc->getBody();
 
-		std::shared_ptr<RenderComponent> rc = gameObject.renderComponent();
-		std::shared_ptr<SpriteRenderComponent> spriteComponent =
-				std::static_pointer_cast < SpriteRenderComponent > (rc);
+		SpriteRenderComponent *spriteComponent =
+				static_cast<SpriteRenderComponent*>(gameObject.renderComponent().get());
 		pc->addFy(mGravity);
 
 		if (left && !right) {
@@ -83,11 +86,10 @@ public:
 
 		if (jump) {
 			bool onGround = false;
-			std::vector < std::shared_ptr < GameObject >> objects;
 			if (PhysicsManager::getInstance().getCollisions(gameObject.x() + 1,
 					gameObject.y() + gameObject.h(), gameObject.w() - 2, 2.0f,
-					objects)) {
-				for (auto obj : objects) {
+					mGroundObjects)) {
+				for (auto obj : mGroundObjects) {
 					if (obj->tag() == TAG_BLOCK) {
 						onGround = true;
 					}
@@ -112,14 +114,18 @@ private:
 	float mJump;
 	float mGravity;
 	Mix_Chunk *jSound;
+	std::vector<GameObject*> mGroundObjects; // kept so jumping does not allocate
 };
 
 const float SIZE = 40.0f;
 
+//the player is drawn over everything else, which is in layer 0
+static const Uint8 LAYER_PLAYER = 1;
+
 class JmpPlayer: public GameObject {
 public:
 	JmpPlayer(Level &level, float x, float y,
-			std::vector<SDL_Texture*> playerTextures, Mix_Chunk *jumpSound,
+			std::vector<Sprite> playerSprites, Mix_Chunk *jumpSound,
 			Mix_Chunk *goalSound, Mix_Chunk *collectibleSound) :
 			GameObject(level, x, y, SIZE, SIZE, TAG_PLAYER) {
 		addGenericComponent(
@@ -136,7 +142,8 @@ public:
 						> (*this, PhysicsComponent::Type::DYNAMIC_SOLID));
 		setRenderComponent(
 				std::make_shared < SpriteRenderComponent
-						> (*this, playerTextures));
+						> (*this, playerSprites));
+		renderComponent()->setLayer(LAYER_PLAYER);
 	}
 };
 
@@ -156,28 +163,29 @@ public:
 class Collectible: public GameObject {
 public:
 	Collectible(Level &level, float x, float y,
-			std::vector<SDL_Texture*> collectibleTextures) :
+			std::vector<Sprite> collectibleSprites) :
 			GameObject(level, x, y, SIZE, SIZE, TAG_COLLECTIBLE) {
 		setPhysicsComponent(
 				std::make_shared < PhysicsComponent
 						> (*this, PhysicsComponent::Type::STATIC_SENSOR));
 		setRenderComponent(
 				std::make_shared < SpriteRenderComponent
-						> (*this, collectibleTextures));
+						> (*this, collectibleSprites));
 	}
 };
 
 class JmpBlock: public GameObject {
 public:
 	JmpBlock(Level &level, float x, float y,
-			std::vector<SDL_Texture*> blockTextures) :
+			std::vector<Sprite> blockSprites) :
 			GameObject(level, x, y, SIZE, SIZE, TAG_BLOCK) {
+		setStatic(true);
 		setPhysicsComponent(
 				std::make_shared < PhysicsComponent
 						> (*this, PhysicsComponent::Type::STATIC_SOLID));
 		setRenderComponent(
 				std::make_shared < SpriteRenderComponent
-						> (*this, blockTextures));
+						> (*this, blockSprites));
 	}
 };
 
@@ -222,8 +230,9 @@ public:
 			auto player =
 					std::make_shared < JmpPlayer
 							> (*this, position.first * SIZE, position.second
-									* SIZE, playerTextures, levelSounds[0], levelSounds[3], levelSounds[2]);
+									* SIZE, playerSprites, levelSounds[0], levelSounds[3], levelSounds[2]);
 			addObject(player);
+			camera().follow(player);
 		}
 			break;
 
@@ -238,7 +247,7 @@ public:
 			addObject(
 					std::make_shared < JmpBlock
 							> (*this, position.first * SIZE, position.second
-									* SIZE, blockTextures));
+									* SIZE, blockSprites));
 			break;
 		}
 
@@ -254,7 +263,7 @@ public:
 			addObject(
 					std::make_shared < Collectible
 							> (*this, position.first * SIZE, position.second
-									* SIZE, collectibleTextures));
+									* SIZE, collectibleSprites));
 		}
 		}
 	}
@@ -262,34 +271,34 @@ public:
 	void initialize(SDL_Renderer *renderer) override
 	{
 		finalize();
+
+		// every sprite is a region of the atlas packed at load time, whose
+		// texture is made once and shared by the levels
+		const SpriteAtlas &atlas = ResourceManager::getInstance().spriteAtlas;
+		atlasTexture = ResourceManager::getInstance().getSpriteAtlasTexture(
+				renderer);
+		playerSprites.clear();
+		blockSprites.clear();
+		collectibleSprites.clear();
 		for (size_t i = 0; i < 4; i++) {
-			SDL_Texture *newTexture = SDL_CreateTextureFromSurface(renderer,
-					levelSurfaces[i]);
-			if (newTexture == NULL) {
-				SDL_Log("Failed to create texture");
-			} else {
-				SDL_Log("Loaded texture");
-			}
-			playerTextures.push_back(newTexture);
+			Sprite sprite = atlas.sprite(atlasTexture->texture, levelSurfaces[i]);
+			playerSprites.push_back(sprite);
 		}
 
-		SDL_Texture *block = SDL_CreateTextureFromSurface(renderer,
-				levelSurfaces[4]);
-		if (block == NULL) {
-			SDL_Log("Failed to create texture");
-		} else {
-			SDL_Log("Loaded texture");
-		}
-		blockTextures.push_back(block);
+		Sprite block = atlas.sprite(atlasTexture->texture, levelSurfaces[4]);
+		blockSprites.push_back(block);
 
-		SDL_Texture *collectibleTexture = SDL_CreateTextureFromSurface(renderer,
+		Sprite collectible = atlas.sprite(atlasTexture->texture,
 				levelSurfaces[5]);
-		if (block == NULL) {
-			SDL_Log("Failed to create texture");
-		} else {
-			SDL_Log("Loaded texture");
+		collectibleSprites.push_back(collectible);
+
+		// a level may be wider or taller than the window; the camera scrolls
+		std::size_t columns = 0;
+		for (const std::string &row : levelLayout) {
+			columns = std::max(columns, row.size());
 		}
-		collectibleTextures.push_back(collectibleTexture);
+		setWorldSize(std::max(w(), int(columns * SIZE)),
+				std::max(h(), int(levelLayout.size() * SIZE)));
 
 		float xPos = 0;
 		float yPos = 0;
@@ -321,36 +330,50 @@ public:
 private:
 	std::vector<std::string> levelLayout;
 	std::vector<SDL_Surface*> levelSurfaces;
-	std::vector<SDL_Texture*> playerTextures;
-	std::vector<SDL_Texture*> blockTextures;
-	std::vector<SDL_Texture*> collectibleTextures;
+	std::vector<Sprite> playerSprites;
+	std::vector<Sprite> blockSprites;
+	std::vector<Sprite> collectibleSprites;
+	TextureHandle atlasTexture;
 	std::vector<Mix_Chunk*> levelSounds;
 }
 ;
 
 int main(int argc, char **argv) {
-	//Initialize SDL_mixer
-	if (Mix_OpenAudio(44100, MIX_DEFAULT_FORMAT, 2, 2048) < 0) {
+	// --headless runs the levels with no window, e.g. for soak tests
+	RunOptions options = RunOptions::parse(argc, argv);
+
+	//Initialize SDL_mixer; headless runs play nothing, so open no device
+	if (!options.headless
+			&& Mix_OpenAudio(44100, MIX_DEFAULT_FORMAT, 2, 2048) < 0) {
 		printf("SDL_mixer could not initialize! SDL_mixer Error: %s\n",
 				Mix_GetError());
 	}
 	//int channel;
 	ResourceManager::getInstance().startUp();
-	ResourceManager::getInstance().loadLevel("/Levels/level1.txt");
-	ResourceManager::getInstance().loadLevel("/Levels/level2.txt");
-	ResourceManager::getInstance().loadLevel("/Levels/level3.txt");
-	ResourceManager::getInstance().loadSurface("Sprites/slime.png");
-	ResourceManager::getInstance().loadSurface("Sprites/slimeleft.png");
-	ResourceManager::getInstance().loadSurface("Sprites/slimejump.png");
-	ResourceManager::getInstance().loadSurface("Sprites/slimejumpleft.png");
-	ResourceManager::getInstance().loadSurface("Sprites/tile.png");
-	ResourceManager::getInstance().loadSurface("Sprites/collectible.png");
-	ResourceManager::getInstance().loadJumpEffect("Sounds/Jump.wav");
-	ResourceManager::getInstance().loadMissEffect("Sounds/Death.wav");
-	ResourceManager::getInstance().loadBGM("Sounds/BGM.wav");
-
-	ResourceManager::getInstance().loadCollectEffect("Sounds/Collectible.wav");
-	ResourceManager::getInstance().loadGoalEffect("Sounds/Goal.wav");
+	// assets packed by bin/packer (make pack) are read from the archive
+	ResourceManager::getInstance().openArchive("assets.pak");
+	ResourceManager::getInstance().loadLevelAsync("/Levels/level1.txt");
+	ResourceManager::getInstance().loadLevelAsync("/Levels/level2.txt");
+	ResourceManager::getInstance().loadLevelAsync("/Levels/level3.txt");
+	ResourceManager::getInstance().loadSurfaceAsync("Sprites/slime.png");
+	ResourceManager::getInstance().loadSurfaceAsync("Sprites/slimeleft.png");
+	ResourceManager::getInstance().loadSurfaceAsync("Sprites/slimejump.png");
+	ResourceManager::getInstance().loadSurfaceAsync("Sprites/slimejumpleft.png");
+	ResourceManager::getInstance().loadSurfaceAsync("Sprites/tile.png");
+	ResourceManager::getInstance().loadSurfaceAsync("Sprites/collectible.png");
+	ResourceManager::getInstance().loadEffectAsync("Sounds/Jump.wav",
+			&ResourceManager::jumpEff);
+	ResourceManager::getInstance().loadEffectAsync("Sounds/Death.wav",
+			&ResourceManager::missEff);
+	ResourceManager::getInstance().loadBGMAsync("Sounds/BGM.wav");
+
+	ResourceManager::getInstance().loadEffectAsync("Sounds/Collectible.wav",
+			&ResourceManager::collectEff);
+	ResourceManager::getInstance().loadEffectAsync("Sounds/Goal.wav",
+			&ResourceManager::goalEff);
+	// the files above load side by side on loader threads; this waits
+	ResourceManager::getInstance().finishLoading();
+	ResourceManager::getInstance().packSprites();
 
 	std::vector<Mix_Chunk*> soundVector;
 	soundVector.push_back(ResourceManager::getInstance().jumpEff);
@@ -382,8 +405,20 @@ int main(int argc, char **argv) {
 			"Avoid the enemies and reach the goal at the end to win!\n"
 			"Press n to skip to the next level.\n"
 			"Press r to restart the level.\n";
-	SDLGraphicsProgram mySDLGraphicsProgram(levels, GAME_ID);
-	mySDLGraphicsProgram.loop();
+	int status = 0;
+	if (options.headless) {
+		HeadlessProgram headlessProgram(levels, options);
+		if (!headlessProgram.run()) {
+			status = 1;
+		}
+	} else {
+		SDLGraphicsProgram mySDLGraphicsProgram(levels, GAME_ID);
+		if (!options.record.empty()) {
+			mySDLGraphicsProgram.recordInput(options.record);
+		}
+		mySDLGraphicsProgram.setPipelined(options.pipelined);
+		mySDLGraphicsProgram.loop();
+	}
 	ResourceManager::getInstance().shutDown();
-	return 0;
+	return status;
 }
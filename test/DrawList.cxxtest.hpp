@@ -0,0 +1,149 @@
+#include <cxxtest/TestSuite.h>
+
+#include "base/DrawList.hpp"
+#include <vector>
+
+// The order DrawList::render draws in, checked through sort, so no
+// renderer is needed.  Textures are only compared, never used, so any
+// distinct addresses stand in for them.
+class DrawListTest: public CxxTest::TestSuite {
+public:
+
+	void testEqualKeysKeepTheirOrder() {
+		DrawList list;
+		const SDL_Color red = { 0xFF, 0, 0, 0xFF };
+		for (int i = 0; i < 5; i++) {
+			list.fill(2, rect(i), red);
+		}
+		list.sort();
+		TS_ASSERT_EQUALS(order(list), sequence(0, 5));
+	}
+
+	void testEqualSpritesKeepTheirOrder() {
+		DrawList list;
+		for (int i = 0; i < 5; i++) {
+			list.draw(1, sprite(0), dest(i));
+		}
+		list.sort();
+		TS_ASSERT_EQUALS(order(list), sequence(0, 5));
+	}
+
+	// Every key has the same layer, so that byte is skipped; the colours
+	// differ in one byte only, so all the rest are skipped too
+	void testSortsOnTheOnlyDigitThatDiffers() {
+		DrawList list;
+		for (int i = 0; i < 6; i++) {
+			SDL_Color color = { Uint8(0x50 - 0x10 * (i / 2)), 0, 0, 0xFF };
+			list.fill(7, rect(i), color);
+		}
+		list.sort();
+		const std::size_t expected[] = { 4, 5, 2, 3, 0, 1 };
+		TS_ASSERT_EQUALS(order(list), std::vector<std::size_t>(expected,
+				expected + 6));
+	}
+
+	void testSortsAcrossSeveralDigits() {
+		DrawList list;
+		const SDL_Color low = { 0x01, 0x00, 0x00, 0xFF };
+		const SDL_Color high = { 0x01, 0x00, 0x02, 0xFF };
+		const SDL_Color higher = { 0x02, 0x00, 0x00, 0xFF };
+		list.fill(0, rect(0), higher);
+		list.fill(0, rect(1), high);
+		list.fill(0, rect(2), low);
+		list.fill(0, rect(3), high);
+		list.sort();
+		const std::size_t expected[] = { 2, 1, 3, 0 };
+		TS_ASSERT_EQUALS(order(list), std::vector<std::size_t>(expected,
+				expected + 4));
+	}
+
+	// Layer first, then rectangles before sprites, then sprites by
+	// texture in the order textures were first seen and rectangles by
+	// colour
+	void testKeyPrecedence() {
+		DrawList list;
+		const SDL_Color dark = { 0x10, 0x10, 0x10, 0xFF };
+		const SDL_Color light = { 0xF0, 0xF0, 0xF0, 0xFF };
+		list.draw(0, sprite(0), dest(0)); // texture 0 seen first
+		list.fill(1, rect(1), dark);
+		list.draw(0, sprite(1), dest(2));
+		list.fill(0, rect(3), light);
+		list.draw(0, sprite(0), dest(4));
+		list.fill(0, rect(5), dark);
+		list.draw(1, sprite(1), dest(6));
+		list.sort();
+		const std::size_t expected[] = { 5, 3, 0, 4, 2, 1, 6 };
+		TS_ASSERT_EQUALS(order(list), std::vector<std::size_t>(expected,
+				expected + 7));
+	}
+
+	// Texture numbers outlast the frame, so sprites sort the same way
+	// whichever texture a frame happens to queue first
+	void testTextureOrderLastsAcrossFrames() {
+		DrawList list;
+		list.draw(0, sprite(0), dest(0));
+		list.draw(0, sprite(1), dest(1));
+		list.sort();
+		list.begin();
+		list.draw(0, sprite(1), dest(0));
+		list.draw(0, sprite(0), dest(1));
+		list.sort();
+		const std::size_t expected[] = { 1, 0 };
+		TS_ASSERT_EQUALS(order(list), std::vector<std::size_t>(expected,
+				expected + 2));
+	}
+
+	void testBeginForgetsTheQueue() {
+		DrawList list;
+		const SDL_Color red = { 0xFF, 0, 0, 0xFF };
+		list.fill(0, rect(0), red);
+		list.begin();
+		TS_ASSERT_EQUALS(list.size(), 0u);
+	}
+
+	void testSpritesWithoutATextureAreSkipped() {
+		DrawList list;
+		Sprite none = { nullptr, { 0, 0, 1, 1 } };
+		list.draw(0, none, dest(0));
+		TS_ASSERT_EQUALS(list.size(), 0u);
+	}
+
+private:
+
+	char mTextures[2];
+
+	Sprite sprite(int texture) {
+		Sprite sprite = {
+				reinterpret_cast<SDL_Texture*>(&mTextures[texture]), { 0, 0,
+						1, 1 } };
+		return sprite;
+	}
+
+	static SDL_Rect rect(int i) {
+		SDL_Rect rect = { i, 0, 1, 1 };
+		return rect;
+	}
+
+	static SDL_FRect dest(int i) {
+		SDL_FRect dest = { float(i), 0.0f, 1.0f, 1.0f };
+		return dest;
+	}
+
+	static std::vector<std::size_t> order(const DrawList &list) {
+		std::vector<std::size_t> order;
+		for (std::size_t i = 0; i < list.size(); i++) {
+			order.push_back(list.queuedIndex(i));
+		}
+		return order;
+	}
+
+	static std::vector<std::size_t> sequence(std::size_t begin,
+			std::size_t end) {
+		std::vector<std::size_t> sequence;
+		for (std::size_t i = begin; i < end; i++) {
+			sequence.push_back(i);
+		}
+		return sequence;
+	}
+
+};
@@ -0,0 +1,141 @@
+#include <cxxtest/TestSuite.h>
+
+#include "base/InputManager.hpp"
+#include "base/InputRecording.hpp"
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+// Recordings go through a file next to the build's objects, removed after
+// each test.  Key state is set on the input manager directly, as a replay
+// does, rather than through SDL events.
+class InputRecordingTest: public CxxTest::TestSuite {
+public:
+
+	void tearDown() {
+		std::remove(FILENAME);
+		InputManager::getInstance().setSnapshot(InputManager::Snapshot());
+	}
+
+	// SDLK_UP and its neighbours are above 2^30, so their varints take
+	// five bytes; level 300 and the long gap before the last record take
+	// two
+	void testRoundTrip() {
+		std::vector<InputManager::Snapshot> steps = script();
+		InputRecording recording;
+		TS_ASSERT(recording.startRecording(FILENAME, 0xDEADBEEF, 1.0f / 60));
+		for (std::size_t i = 0; i < steps.size(); i++) {
+			if (i == 0) {
+				recording.levelStarted(0);
+			} else if (i == 4) {
+				recording.levelStarted(300);
+			}
+			InputManager::getInstance().setSnapshot(steps[i]);
+			recording.beginStep();
+		}
+		recording.finish();
+
+		InputRecording replay;
+		TS_ASSERT(replay.startReplay(FILENAME));
+		TS_ASSERT_EQUALS(replay.seed(), 0xDEADBEEFu);
+		TS_ASSERT_EQUALS(replay.timeStep(), 1.0f / 60);
+		InputManager::getInstance().setSnapshot(InputManager::Snapshot());
+		std::vector<int> levels;
+		for (std::size_t i = 0; i < steps.size(); i++) {
+			TS_ASSERT(!replay.isFinished());
+			int levelNum;
+			while (replay.levelToStart(levelNum)) {
+				levels.push_back(levelNum);
+				TS_ASSERT_EQUALS(replay.step(), i == 0 ? 0 : 4);
+			}
+			replay.beginStep();
+			InputManager::Snapshot seen;
+			InputManager::getInstance().getSnapshot(seen);
+			TS_ASSERT_EQUALS(seen.down, steps[i].down);
+			TS_ASSERT_EQUALS(seen.pressed, steps[i].pressed);
+		}
+		TS_ASSERT(replay.isFinished());
+		TS_ASSERT_EQUALS(levels.size(), 2u);
+		TS_ASSERT_EQUALS(levels[0], 0);
+		TS_ASSERT_EQUALS(levels[1], 300);
+	}
+
+	// Cutting the file anywhere after the header stops the replay early,
+	// before the recorded length, without reading past the data
+	void testTruncatedRecordingEndsEarly() {
+		std::vector<InputManager::Snapshot> steps = script();
+		InputRecording recording;
+		recording.startRecording(FILENAME, 1, 1.0f / 60);
+		for (const InputManager::Snapshot &snapshot : steps) {
+			InputManager::getInstance().setSnapshot(snapshot);
+			recording.beginStep();
+		}
+		recording.finish();
+		std::vector<char> data = readFile();
+		for (std::size_t size = HEADER_SIZE; size < data.size(); size++) {
+			writeFile(std::vector<char>(data.begin(), data.begin() + size));
+			InputRecording replay;
+			TS_ASSERT(replay.startReplay(FILENAME));
+			long limit = long(steps.size());
+			while (!replay.isFinished() && replay.step() <= limit) {
+				replay.beginStep();
+			}
+			TS_ASSERT(replay.isFinished());
+			TS_ASSERT_LESS_THAN(replay.step(), limit);
+		}
+	}
+
+	void testNotARecording() {
+		InputRecording replay;
+		writeFile(std::vector<char>());
+		TS_ASSERT(!replay.startReplay(FILENAME));
+		writeFile(std::vector<char>({ 'R', 'P', 'L', 'Y' }));
+		TS_ASSERT(!replay.startReplay(FILENAME));
+		writeFile(std::vector<char>({ 'R', 'P', 'L', 'Y', 1, 0, 0 }));
+		TS_ASSERT(!replay.startReplay(FILENAME));
+		writeFile(std::vector<char>({ 'W', 'A', 'V', 'E', 1, 0, 0, 0, 0, 0, 0,
+				0, 0, 0, 2 }));
+		TS_ASSERT(!replay.startReplay(FILENAME));
+		TS_ASSERT(!replay.isReplaying());
+		TS_ASSERT(!replay.startReplay("build/no-such-recording.rply"));
+	}
+
+private:
+
+	static const char *const FILENAME;
+	static const std::size_t HEADER_SIZE = 13; // magic, version, two words
+
+	// Keys held over several steps, so only changes are written, and a
+	// gap of 200 unchanged steps at the end
+	static std::vector<InputManager::Snapshot> script() {
+		std::vector<InputManager::Snapshot> steps(210);
+		steps[1].down = { SDLK_UP };
+		steps[1].pressed = { SDLK_UP };
+		for (int i = 2; i < 6; i++) {
+			steps[i].down = { SDLK_UP };
+		}
+		steps[6].down = { SDLK_a, SDLK_RIGHT, SDLK_UP };
+		steps[6].pressed = { SDLK_a, SDLK_RIGHT };
+		steps[7].down = { SDLK_a, SDLK_RIGHT };
+		steps[9].down = { SDLK_SPACE };
+		steps[9].pressed = { SDLK_SPACE };
+		return steps;
+	}
+
+	static std::vector<char> readFile() {
+		std::ifstream in(FILENAME, std::ios::binary);
+		return std::vector<char>(std::istreambuf_iterator<char>(in),
+				std::istreambuf_iterator<char>());
+	}
+
+	static void writeFile(const std::vector<char> &data) {
+		std::ofstream out(FILENAME, std::ios::binary | std::ios::trunc);
+		out.write(data.data(), data.size());
+	}
+
+};
+
+const char *const InputRecordingTest::FILENAME =
+		"build/InputRecording.cxxtest.rply";
@@ -0,0 +1,95 @@
+#include <cxxtest/TestSuite.h>
+
+#include "base/SlotMap.hpp"
+#include <vector>
+
+class SlotMapTest: public CxxTest::TestSuite {
+public:
+
+	void testInsertAndGet() {
+		SlotMap<int> map;
+		SlotHandle a = map.insert(1);
+		SlotHandle b = map.insert(2);
+		TS_ASSERT(!a.isNull());
+		TS_ASSERT_DIFFERS(a, b);
+		TS_ASSERT_EQUALS(map.size(), 2u);
+		TS_ASSERT_EQUALS(*map.get(a), 1);
+		TS_ASSERT_EQUALS(*map.get(b), 2);
+	}
+
+	void testNullHandleResolvesToNothing() {
+		SlotMap<int> map;
+		map.insert(1);
+		TS_ASSERT(!map.contains(SlotHandle::null()));
+		TS_ASSERT(map.get(SlotHandle::null()) == nullptr);
+	}
+
+	// The freed slot is used again, under a new generation, so the old
+	// handle does not reach the new value
+	void testReusedSlotGetsANewGeneration() {
+		SlotMap<int> map;
+		SlotHandle old = map.insert(1);
+		TS_ASSERT(map.erase(old));
+		SlotHandle reused = map.insert(2);
+		TS_ASSERT_EQUALS(reused.index, old.index);
+		TS_ASSERT_DIFFERS(reused.generation, old.generation);
+		TS_ASSERT(!reused.isNull());
+		TS_ASSERT(!map.contains(old));
+		TS_ASSERT(map.get(old) == nullptr);
+		TS_ASSERT_EQUALS(*map.get(reused), 2);
+	}
+
+	void testErasingAStaleHandleDoesNothing() {
+		SlotMap<int> map;
+		SlotHandle old = map.insert(1);
+		map.erase(old);
+		SlotHandle reused = map.insert(2);
+		TS_ASSERT(!map.erase(old));
+		TS_ASSERT_EQUALS(map.size(), 1u);
+		TS_ASSERT_EQUALS(*map.get(reused), 2);
+	}
+
+	// Erasing moves the last value into the hole; its handle follows it
+	void testHandlesSurviveErasingOthers() {
+		SlotMap<int> map;
+		SlotHandle a = map.insert(1);
+		SlotHandle b = map.insert(2);
+		SlotHandle c = map.insert(3);
+		map.erase(a);
+		TS_ASSERT_EQUALS(map.size(), 2u);
+		TS_ASSERT_EQUALS(*map.get(b), 2);
+		TS_ASSERT_EQUALS(*map.get(c), 3);
+		TS_ASSERT_EQUALS(map[0], 3);
+		TS_ASSERT_EQUALS(map[1], 2);
+	}
+
+	void testClearMakesEveryHandleStale() {
+		SlotMap<int> map;
+		SlotHandle a = map.insert(1);
+		SlotHandle b = map.insert(2);
+		map.clear();
+		TS_ASSERT(map.empty());
+		TS_ASSERT(!map.contains(a));
+		TS_ASSERT(!map.contains(b));
+		SlotHandle c = map.insert(3);
+		TS_ASSERT(!map.contains(a));
+		TS_ASSERT(!map.contains(b));
+		TS_ASSERT_EQUALS(*map.get(c), 3);
+	}
+
+	// Each reuse of a slot gives a handle no earlier one equals
+	void testGenerationsDoNotRepeat() {
+		SlotMap<int> map;
+		std::vector<SlotHandle> handles;
+		for (int i = 0; i < 100; i++) {
+			SlotHandle handle = map.insert(i);
+			for (const SlotHandle &earlier : handles) {
+				TS_ASSERT_DIFFERS(handle, earlier);
+			}
+			handles.push_back(handle);
+			map.erase(handle);
+		}
+		TS_ASSERT(map.empty());
+	}
+
+};
@@ -0,0 +1,108 @@
+#include <cxxtest/TestSuite.h>
+
+#include "base/GameObject.hpp"
+#include "base/Level.hpp"
+#include "base/SpatialGrid.hpp"
+#include <algorithm>
+#include <vector>
+
+// Objects only need a level to belong to; they are never added to it
+class SpatialGridTestLevel: public Level {
+public:
+
+	SpatialGridTestLevel() :
+			Level(100, 100, false, 0) {
+	}
+
+	void initialize(SDL_Renderer*) override {
+	}
+	void makeObject(int, std::pair<int, int>) override {
+	}
+	void restoreHealth() override {
+	}
+
+};
+
+class SpatialGridTest: public CxxTest::TestSuite {
+public:
+
+	void testQueryFindsOverlappingObjects() {
+		SpatialGridTestLevel level;
+		SpatialGrid grid(10.0f);
+		GameObject inside(level, 12, 12, 4, 4, 0);
+		GameObject outside(level, 40, 40, 4, 4, 0);
+		grid.insert(inside);
+		grid.insert(outside);
+		std::vector<GameObject*> found;
+		grid.queryRect(10, 10, 10, 10, found);
+		TS_ASSERT_EQUALS(found.size(), 1u);
+		TS_ASSERT_EQUALS(found[0], &inside);
+	}
+
+	// An object over many cells is listed in each, but reported once
+	// whichever of its cells the query starts in
+	void testObjectsInSeveralCellsAreReportedOnce() {
+		SpatialGridTestLevel level;
+		SpatialGrid grid(10.0f);
+		GameObject wide(level, 5, 5, 30, 30, 0);
+		grid.insert(wide);
+		const float starts[] = { 0, 5, 12, 25 };
+		for (float start : starts) {
+			std::vector<GameObject*> found;
+			grid.queryRect(start, start, 40, 40, found);
+			TS_ASSERT_EQUALS(std::count(found.begin(), found.end(), &wide), 1);
+		}
+		std::vector<GameObject*> found;
+		grid.queryRect(22, 22, 2, 2, found);
+		TS_ASSERT_EQUALS(found.size(), 1u);
+	}
+
+	void testNegativeCoordinates() {
+		SpatialGridTestLevel level;
+		SpatialGrid grid(10.0f);
+		GameObject across(level, -15, -15, 20, 20, 0);
+		grid.insert(across);
+		std::vector<GameObject*> found;
+		grid.queryRect(-30, -30, 60, 60, found);
+		TS_ASSERT_EQUALS(found.size(), 1u);
+		found.clear();
+		grid.queryRect(-1, -1, 1, 1, found);
+		TS_ASSERT_EQUALS(found.size(), 1u);
+	}
+
+	void testUpdateFollowsAMove() {
+		SpatialGridTestLevel level;
+		SpatialGrid grid(10.0f);
+		GameObject mover(level, 0, 0, 4, 4, 0);
+		grid.insert(mover);
+		mover.setX(50);
+		grid.update(mover);
+		std::vector<GameObject*> found;
+		grid.queryRect(0, 0, 9, 9, found);
+		TS_ASSERT(found.empty());
+		grid.queryRect(45, 0, 10, 10, found);
+		TS_ASSERT_EQUALS(found.size(), 1u);
+	}
+
+	void testRemoveAndClear() {
+		SpatialGridTestLevel level;
+		SpatialGrid grid(10.0f);
+		GameObject a(level, 0, 0, 25, 5, 0);
+		GameObject b(level, 0, 0, 5, 5, 0);
+		grid.insert(a);
+		grid.insert(b);
+		grid.insert(a); // already in; no second listing
+		TS_ASSERT_EQUALS(grid.size(), 2u);
+		grid.remove(a);
+		std::vector<GameObject*> found;
+		grid.queryRect(0, 0, 30, 10, found);
+		TS_ASSERT_EQUALS(found.size(), 1u);
+		TS_ASSERT_EQUALS(found[0], &b);
+		grid.clear();
+		TS_ASSERT_EQUALS(grid.size(), 0u);
+		found.clear();
+		grid.queryRect(0, 0, 30, 10, found);
+		TS_ASSERT(found.empty());
+	}
+
+};